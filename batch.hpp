@@ -0,0 +1,87 @@
+#ifndef FMT_BATCH_H
+#define FMT_BATCH_H
+
+/* Defines the batch interface triangulating many independent polygons on multiple threads */
+
+#include "polygon.hpp"
+
+#include <vector>
+
+namespace fmt {
+/*! Triangulates batches of independent polygons on multiple threads.
+
+	The polygons of a batch are given as one flat buffer of interleaved coordinates together with an
+	array of offsets to the first vertex of each polygon. The triangulations of all polygons are
+	written to one concatenated index buffer. Since a polygon with n vertices always has n - 2
+	triangles, the position of every polygon in the output is known up front and threads write to it
+	without synchronisation.
+
+	Work is distributed over the threads by fmt::_::parallel_for, which balances polygons of uneven
+	size by work stealing. Every thread owns a fmt::Workspace and a fmt::Polygon view, which are kept
+	between batches: once they have grown to fit the largest polygon, triangulating further batches
+	performs no heap allocations besides starting the threads and growing the output.
+
+	The vertices of each polygon are expected in clockwise(!) orientation, as for fmt::Polygon.
+
+	@tparam T_vert numeric type of a coordinate component, e.g. float.
+	@tparam T_ind numeric type of an index, e.g. uint_fast32_t. Must be able to index all vertices of
+	the batch.
+*/
+template<class T_vert, class T_ind>
+class BatchTriangulator {
+private:
+	//! State owned by one thread
+	struct ThreadState {
+		Polygon<T_vert, T_ind> poly;
+		Workspace<T_vert, T_ind> ws;
+	};
+
+	std::vector<ThreadState> states; //!< Per-thread state, kept between batches
+	unsigned threads;                //!< Number of threads to use
+
+public:
+	/*! Construct a new batch triangulator.
+
+		@param threads Number of threads to use. 0 uses one thread per hardware thread.
+	*/
+	BatchTriangulator(const unsigned threads = 0);
+
+	/*! Triangulate a batch of polygons.
+
+		@param coords Interleaved x and y coordinates of all vertices of all polygons.
+		@param offsets Array of count + 1 vertex offsets. Polygon i consists of the vertices
+		offsets[i] to offsets[i + 1] - 1. offsets[0] is usually 0.
+		@param count Number of polygons.
+		@param indices Output buffer, resized to hold the indices of all triangles of all polygons.
+		Indices refer to vertices in coords, i.e. they include the offset of their polygon.
+		@param index_offsets Output array, resized to count + 1 offsets. The indices of polygon i are
+		indices[index_offsets[i]] to indices[index_offsets[i + 1] - 1].
+		@param grain Number of polygons claimed by a thread at once. Defaults to 64.
+
+		@throws std::invalid_argument If a polygon has less than three vertices.
+	*/
+	void triangulate(const T_vert* coords, const T_ind* offsets, const T_ind count,
+									 std::vector<T_ind>& indices, std::vector<T_ind>& index_offsets,
+									 const T_ind grain = T_ind(64));
+};
+
+/*! Triangulate a batch of polygons on multiple threads.
+
+	Convenience function constructing a temporary fmt::BatchTriangulator. To avoid repeated
+	allocation of the per-thread workspaces, keep a BatchTriangulator instead. See
+	fmt::BatchTriangulator::triangulate for the parameters.
+
+	@param threads Number of threads to use. 0 uses one thread per hardware thread.
+*/
+template<class T_vert, class T_ind>
+void triangulate_batch(const T_vert* coords, const T_ind* offsets, const T_ind count,
+											 std::vector<T_ind>& indices, std::vector<T_ind>& index_offsets,
+											 const unsigned threads = 0) {
+	BatchTriangulator<T_vert, T_ind>(threads).triangulate(coords, offsets, count, indices,
+																												index_offsets);
+}
+} // namespace fmt
+
+#include "batch.ipp"
+
+#endif
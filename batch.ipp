@@ -0,0 +1,55 @@
+#ifndef FMT_BATCH_IPP
+#define FMT_BATCH_IPP
+
+#include "batch.hpp"
+#include "parallel.hpp"
+
+#ifndef FMT_NOEXCEPT
+#	include <stdexcept>
+#endif
+
+template<class T_vert, class T_ind>
+fmt::BatchTriangulator<T_vert, T_ind>::BatchTriangulator(const unsigned threads)
+		: threads(threads ? threads : _::default_threads()) {}
+
+template<class T_vert, class T_ind>
+void fmt::BatchTriangulator<T_vert, T_ind>::triangulate(const T_vert* coords, const T_ind* offsets,
+																												const T_ind count, std::vector<T_ind>& indices,
+																												std::vector<T_ind>& index_offsets,
+																												const T_ind grain) {
+	// Every polygon with n vertices has n - 2 triangles, so all output offsets are known up front
+	index_offsets.resize(count + 1);
+	index_offsets[0] = T_ind(0);
+	for (T_ind i = T_ind(0); i < count; ++i) {
+		const T_ind n = offsets[i + 1] - offsets[i];
+#ifndef FMT_NOEXCEPT
+		if (n < 3)
+			throw std::invalid_argument("Cannot triangulate polygon with less than three vertices.");
+#endif
+		index_offsets[i + 1] = index_offsets[i] + T_ind(3) * (n - T_ind(2));
+	}
+	indices.resize(index_offsets[count]);
+
+	if (states.size() < threads) states.resize(threads);
+
+	_::parallel_for(count, grain, threads, [&](const T_ind begin, const T_ind end, const unsigned t) {
+		ThreadState& state = states[t];
+		for (T_ind i = begin; i < end; ++i) {
+			const T_ind first = offsets[i];
+			T_ind* const out = indices.data() + index_offsets[i];
+
+			state.poly.set_vertices(coords + 2 * first, offsets[i + 1] - first);
+			const T_ind written = state.poly.get_indices(out, state.ws);
+#ifndef FMT_NOEXCEPT
+			if (written != index_offsets[i + 1] - index_offsets[i])
+				throw std::runtime_error(
+						"Triangulation has less than n - 2 triangles. Is the polygon simple?");
+#endif
+
+			// Offset local indices to refer to the vertices in the flat buffer
+			for (T_ind* it = out; it != out + written; ++it)
+				*it += first;
+		}
+	});
+}
+#endif
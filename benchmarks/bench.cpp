@@ -9,6 +9,7 @@
 #include <list>
 #include <ostream>
 #include <ratio>
+#include <set>
 #include <utility>
 #include <vector>
 
@@ -51,13 +52,24 @@ using namespace std;
 
 constexpr float RADIUS = 100;
 
-// Generate random n-vertex polygon
-TPPLPoly* rpg(unsigned int size) { // we apologise for the inconvenience
+// Generate random n-vertex polygon. If grid is set, the vertices are snapped to a grid of about
+// 2 sqrt(n) columns, so that many vertices share their x coordinate as on axis-aligned inputs.
+TPPLPoly* rpg(unsigned int size, bool grid = false) { // we apologise for the inconvenience
 	Polygon_2 polygon;
 	list<Point_2> point_set;
 
 	point_set.clear();
-	CGAL::copy_n_unique(Point_generator(RADIUS), size, back_inserter(point_set));
+	if (grid) {
+		const float cell = RADIUS / ceil(sqrt(size));
+		set<pair<float, float>> seen;
+		Point_generator gen(RADIUS);
+		while (point_set.size() < size) {
+			const Point_2 p = *(gen++);
+			const Point_2 snapped(round(p.x() / cell) * cell, round(p.y() / cell) * cell);
+			if (seen.insert(make_pair(snapped.x(), snapped.y())).second) point_set.push_back(snapped);
+		}
+	} else
+		CGAL::copy_n_unique(Point_generator(RADIUS), size, back_inserter(point_set));
 
 	CGAL::random_polygon_2(point_set.size(), back_inserter(polygon), point_set.begin());
 
@@ -78,6 +90,17 @@ TPPLPoly* rpg(unsigned int size) { // we apologise for the inconvenience
 	return poly;
 }
 
+// Copy the vertices of a polygon in clockwise order for FastMono
+vector<float> to_cw(const TPPLPoly* tppl_poly) {
+	vector<float> v_cw;
+	v_cw.reserve(tppl_poly->GetNumPoints() * 2);
+	for (int j = tppl_poly->GetNumPoints() - 1; j >= 0; --j) {
+		v_cw.push_back(static_cast<float>((*tppl_poly)[j].x));
+		v_cw.push_back(static_cast<float>((*tppl_poly)[j].y));
+	}
+	return v_cw;
+}
+
 constexpr unsigned int ITERATIONS = 10000;
 unsigned int N = 100;
 
@@ -99,7 +122,7 @@ int main(int argc, char* argv[]) {
 
 	ostream csvstream(&fb);
 
-	csvstream << "N,GEN,EC,MONO,FMT" << endl;
+	csvstream << "N,GEN,EC,MONO,FMT,FMT_GRID" << endl;
 
 	if (argc == 3) N = stoi(argv[2]);
 
@@ -130,24 +153,27 @@ int main(int argc, char* argv[]) {
 			// cout << e.what() << endl;
 			//}
 
-			vector<float> v_cw;
-			v_cw.reserve(tppl_poly->GetNumPoints() * 2);
-			for (int j = tppl_poly->GetNumPoints() - 1; j >= 0; --j) {
-				v_cw.push_back(static_cast<float>((*tppl_poly)[j].x));
-				v_cw.push_back(static_cast<float>((*tppl_poly)[j].y));
-			}
-
-			fmt::Polygon<float, unsigned int> fmt_poly = fmt::Polygon<float, unsigned int>(v_cw);
+			fmt::Polygon<float, unsigned int> fmt_poly(to_cw(tppl_poly));
 
 			start = chrono::steady_clock::now();
 			fmt_poly.get_indices();
 			end = chrono::steady_clock::now();
 			diff _t_fmt = end - start;
 
+			// Grid-aligned polygon with heavy ties in x
+			TPPLPoly* grid_poly = rpg(N, true);
+			fmt::Polygon<float, unsigned int> fmt_grid(to_cw(grid_poly));
+
+			start = chrono::steady_clock::now();
+			fmt_grid.get_indices();
+			end = chrono::steady_clock::now();
+			diff _t_fmt_grid = end - start;
+
 			csvstream << N << "," << _t_gen.count() << "," << _t_ec.count() << "," << _t_mono.count()
-								<< "," << _t_fmt.count() << endl;
+								<< "," << _t_fmt.count() << "," << _t_fmt_grid.count() << endl;
 
 			delete tppl_poly;
+			delete grid_poly;
 		}
 
 		cout << "\rDone with N=" << N << ". Now benchmarking N=" << (unsigned int) (N * 1.05) << flush;
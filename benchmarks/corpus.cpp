@@ -0,0 +1,151 @@
+/* Command line tool for corpus files, see ../corpus.hpp.
+ *
+ * Generates corpora of seeded polygons, see ./generators.hpp, and triangulates corpora of any size
+ * in a stream: the polygons are mapped into memory and triangulated in chunks of at most
+ * CHUNK_VERTICES vertices by fmt::BatchTriangulator, straight from the mapping. The triangulations
+ * are written as a corpus of triangles with three uint32 indices each, counting from the first
+ * vertex of their polygon, which can be mapped in turn. Memory use is bounded by the chunk size,
+ * regardless of the size of the corpus.
+ *
+ * Usage: corpus generate output.fmtc [count] [n] [seed]
+ *        corpus triangulate input.fmtc output.fmtc [threads]
+ *        corpus info input.fmtc
+ */
+
+#include "generators.hpp"
+
+#include "../batch.hpp"  // FastMono batch interface
+#include "../corpus.hpp" // Corpus files
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+typedef uint32_t T_ind;
+typedef chrono::steady_clock Clock;
+
+constexpr uint64_t CHUNK_VERTICES = 1 << 20;
+
+int usage() {
+	cerr << "Usage: corpus generate output.fmtc [count] [n] [seed]" << endl
+			 << "       corpus triangulate input.fmtc output.fmtc [threads]" << endl
+			 << "       corpus info input.fmtc" << endl;
+	return 1;
+}
+
+//! Read the header of a corpus, to find the type of its values
+bool read_header(const char* path, fmt::CorpusHeader& header) {
+	FILE* file = fopen(path, "rb");
+	if (!file) return false;
+	const bool read = fread(&header, sizeof(header), 1, file) == 1;
+	fclose(file);
+	return read && header.magic == fmt::CorpusHeader::MAGIC;
+}
+
+//! Write count polygons of n vertices, cycling through the generators
+int generate(const char* path, const uint64_t count, const unsigned n, const uint64_t seed) {
+	fmt::CorpusWriter<float> writer(path, 2, count);
+	const vector<bench::Generator>& gens = bench::generators();
+	for (uint64_t i = 0; i < count; ++i) {
+		const vector<float> xy = gens[i % gens.size()].generate(n, seed + i);
+		writer.push(xy.data(), xy.size() / 2);
+	}
+	writer.close();
+	cout << "Wrote " << count << " polygons to " << path << "." << endl;
+	return 0;
+}
+
+//! Triangulate all polygons of a corpus in chunks
+template<class T_vert>
+int triangulate(const char* in_path, const char* out_path, const unsigned threads) {
+	const Clock::time_point begin = Clock::now();
+	const fmt::CorpusView<T_vert> corpus(in_path);
+	if (corpus.arity() != 2) {
+		cerr << in_path << " does not hold polygons." << endl;
+		return 1;
+	}
+	const uint64_t* table = corpus.offsets();
+
+	fmt::CorpusWriter<T_ind> writer(out_path, 3, corpus.size());
+	fmt::BatchTriangulator<T_vert, T_ind> batch(threads);
+	vector<T_ind> offsets, indices, index_offsets;
+	for (uint64_t first = 0, last; first < corpus.size(); first = last) {
+		// Take polygons until the chunk is full, but at least one
+		last = first + 1;
+		while (last < corpus.size() && table[last + 1] - table[first] <= CHUNK_VERTICES)
+			++last;
+		if (table[last] - table[first] > uint64_t(T_ind(-1) / 3)) {
+			cerr << "Polygon " << first << " has too many vertices for 32 bit indices." << endl;
+			return 1;
+		}
+
+		offsets.resize(last - first + 1);
+		for (uint64_t i = first; i <= last; ++i)
+			offsets[i - first] = T_ind(table[i] - table[first]);
+		batch.triangulate(corpus.record(first), offsets.data(), T_ind(last - first), indices,
+											index_offsets);
+
+		// The batch counts indices from the first vertex of the chunk, the corpus per polygon
+		for (T_ind i = 0; i < last - first; ++i) {
+			T_ind* const tris = indices.data() + index_offsets[i];
+			const T_ind length = index_offsets[i + 1] - index_offsets[i];
+			for (T_ind k = 0; k < length; ++k)
+				tris[k] -= offsets[i];
+			writer.push(tris, length / 3);
+		}
+	}
+	writer.close();
+
+	const double seconds = chrono::duration<double>(Clock::now() - begin).count();
+	const double megabytes = corpus.items() * 2 * sizeof(T_vert) / 1e6;
+	cout << "Triangulated " << corpus.size() << " polygons with " << corpus.items() << " vertices in "
+			 << seconds << " s: " << corpus.size() / seconds << " polygons/s, "
+			 << corpus.items() / seconds << " vertices/s, " << megabytes / seconds << " MB/s." << endl;
+	return 0;
+}
+
+int info(const char* path) {
+	fmt::CorpusHeader header;
+	if (!read_header(path, header)) {
+		cerr << path << " is not a corpus." << endl;
+		return 1;
+	}
+	const char* types[] = {"?", "float32", "float64", "int16", "int32", "uint16", "uint32"};
+	cout << path << ": " << header.count << " records, " << header.items << " items of "
+			 << header.arity << " " << types[header.type < 7 ? header.type : 0] << " values" << endl;
+	return 0;
+}
+
+int main(int argc, char* argv[]) {
+	if (argc < 3) return usage();
+	const string command = argv[1];
+	try {
+		if (command == "generate")
+			return generate(argv[2], argc < 4 ? 1000 : stoull(argv[3]),
+											argc < 5 ? 1000 : unsigned(stoul(argv[4])), argc < 6 ? 1 : stoull(argv[5]));
+		if (command == "info") return info(argv[2]);
+		if (command != "triangulate" || argc < 4) return usage();
+
+		const unsigned threads = argc < 5 ? 0 : unsigned(stoul(argv[4]));
+		fmt::CorpusHeader header;
+		if (!read_header(argv[2], header)) {
+			cerr << argv[2] << " is not a corpus." << endl;
+			return 1;
+		}
+		switch (header.type) {
+		case fmt::FLOAT32: return triangulate<float>(argv[2], argv[3], threads);
+		case fmt::FLOAT64: return triangulate<double>(argv[2], argv[3], threads);
+		case fmt::INT32: return triangulate<int32_t>(argv[2], argv[3], threads);
+		default: cerr << argv[2] << " holds coordinates of an unsupported type." << endl; return 1;
+		}
+	} catch (const exception& e) {
+		cerr << e.what() << endl;
+		return 1;
+	}
+}
@@ -0,0 +1,240 @@
+#ifndef FMT_BENCH_GENERATORS_H
+#define FMT_BENCH_GENERATORS_H
+
+/* Deterministic generators of simple polygons for the benchmarks. Every generator takes a seed and
+ * returns the same polygon for the same seed and size, as interleaved x and y coordinates in
+ * clockwise orientation. They do not depend on the distributions of the standard library.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace bench {
+
+constexpr double PI = 3.14159265358979323846;
+
+/*! Seeded pseudo-random numbers, splitmix64.
+
+	The distributions of the standard library differ between implementations, so uniform values are
+	taken from the raw bits directly.
+*/
+class Random {
+	uint64_t state;
+
+public:
+	explicit Random(const uint64_t seed) : state(seed) {}
+
+	uint64_t next() {
+		uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+		return z ^ (z >> 31);
+	}
+
+	//! Uniform in [0, 1)
+	double uniform() { return double(next() >> 11) * (1.0 / 9007199254740992.0); }
+
+	//! Uniform in [0, n)
+	unsigned below(const unsigned n) { return unsigned(uniform() * n); }
+};
+
+//! Twice the signed area of a polygon, positive if it is counter-clockwise
+inline double area2(const std::vector<float>& xy) {
+	const std::size_t n = xy.size() / 2;
+	double sum = 0;
+	for (std::size_t i = 0, j = n - 1; i < n; j = i++)
+		sum += double(xy[2 * j]) * xy[2 * i + 1] - double(xy[2 * i]) * xy[2 * j + 1];
+	return sum;
+}
+
+//! Reverse a polygon if it is counter-clockwise
+inline std::vector<float> make_cw(std::vector<float> xy) {
+	if (area2(xy) <= 0) return xy;
+	const std::size_t n = xy.size() / 2;
+	for (std::size_t i = 0; i < n / 2; ++i) {
+		std::swap(xy[2 * i], xy[2 * (n - 1 - i)]);
+		std::swap(xy[2 * i + 1], xy[2 * (n - 1 - i) + 1]);
+	}
+	return xy;
+}
+
+//! Star-shaped polygon with random radii around the origin. Most vertices are events.
+inline std::vector<float> star(const unsigned n, const uint64_t seed) {
+	Random random(seed);
+	std::vector<float> xy;
+	xy.reserve(2 * n);
+	for (unsigned i = 0; i < n; ++i) {
+		const double angle = (i + 0.9 * random.uniform()) * 2 * PI / n;
+		const double radius = 100 * (0.2 + 0.8 * random.uniform());
+		xy.push_back(float(radius * std::cos(angle)));
+		xy.push_back(float(radius * std::sin(angle)));
+	}
+	return make_cw(xy);
+}
+
+//! Band winding around the origin as a spiral. Long monotone chains with few events per turn.
+inline std::vector<float> spiral(const unsigned n, const uint64_t seed) {
+	Random random(seed);
+	const unsigned steps = std::max(3u, n / 2);
+	// Every turn needs enough steps for the edges to stay within the band; small n wind less than
+	// a full turn
+	const double turns = std::min(double(std::max(1u, unsigned(std::sqrt(double(n)) / 4))),
+																steps / 16.0);
+	const double spacing = 10, width = 3;
+	auto push = [&](std::vector<float>& xy, const unsigned i, const double offset) {
+		const double t = 2 * PI * turns * (i + 0.5 + 0.2 * random.uniform()) / steps;
+		const double radius = spacing * (1 + t / (2 * PI)) + offset;
+		xy.push_back(float(radius * std::cos(t)));
+		xy.push_back(float(radius * std::sin(t)));
+	};
+	// Out along the outer edge of the band, back along the inner edge
+	std::vector<float> xy;
+	xy.reserve(4 * steps);
+	for (unsigned i = 0; i < steps; ++i)
+		push(xy, i, width);
+	for (unsigned i = steps; i-- > 0;)
+		push(xy, i, -width);
+	return make_cw(xy);
+}
+
+//! Comb with teeth pointing right from a vertical spine. Every gap adds a split vertex and every
+//! tooth a stop vertex.
+inline std::vector<float> comb(const unsigned n, const uint64_t seed) {
+	Random random(seed);
+	const unsigned teeth = std::max(1u, (n - 2) / 4);
+	const float top = float(4 * teeth);
+	// Down the spine, then the teeth from bottom to top
+	std::vector<float> xy = {0, top, 0, 0};
+	for (unsigned t = 0; t < teeth; ++t) {
+		const float length = float(10 + 90 * random.uniform()), y = float(4 * t);
+		const float tooth[] = {length, y, length, y + 2, 1, y + 2, 1, y + 4};
+		xy.insert(xy.end(), tooth, tooth + 8);
+	}
+	// Fill up to n vertices along the top edge, from right to left
+	for (unsigned k = 1, pad = n - std::min(n, unsigned(xy.size() / 2)); k <= pad; ++k) {
+		xy.push_back(float(1 - double(k) / (pad + 1)));
+		xy.push_back(top);
+	}
+	return make_cw(xy);
+}
+
+//! Rectilinear comb on an integer grid with teeth of random lengths pointing left and right from a
+//! vertical spine. Many vertices share their x coordinate.
+inline std::vector<float> grid(const unsigned n, const uint64_t seed) {
+	Random random(seed);
+	const unsigned teeth = std::max(1u, (n - 3) / 8);
+	std::vector<float> xy;
+	// Up the right side of the spine
+	for (unsigned t = 0; t < teeth; ++t) {
+		const float y = float(4 * t), length = float(1 + random.below(32));
+		const float tooth[] = {1, y, 1 + length, y, 1 + length, y + 2, 1, y + 2};
+		xy.insert(xy.end(), tooth, tooth + 8);
+	}
+	xy.push_back(1);
+	xy.push_back(float(4 * teeth));
+	// Down the left side
+	for (unsigned t = teeth; t-- > 0;) {
+		const float y = float(4 * t + 2), length = float(1 + random.below(32));
+		const float tooth[] = {0, y + 2, -length, y + 2, -length, y, 0, y};
+		xy.insert(xy.end(), tooth, tooth + 8);
+	}
+	// Along the bottom, filled up to n vertices
+	xy.push_back(0);
+	xy.push_back(-1);
+	for (unsigned k = 1, pad = n - std::min(n, unsigned(xy.size() / 2 + 1)); k <= pad; ++k) {
+		xy.push_back(float(double(k) / (pad + 1)));
+		xy.push_back(-1);
+	}
+	xy.push_back(1);
+	xy.push_back(-1);
+	return make_cw(xy);
+}
+
+//! Vertical zigzag band. Every turn of the band adds a split and a start, or a merge and a stop.
+inline std::vector<float> zigzag(const unsigned n, const uint64_t seed) {
+	Random random(seed);
+	const unsigned turns = std::max(2u, n / 2);
+	const double width = 1, height = 4;
+	std::vector<float> right, left;
+	for (unsigned i = 0; i < turns; ++i) {
+		const double x = (i % 2) * (50 + 10 * random.uniform()), y = i * height;
+		right.push_back(float(x + width));
+		right.push_back(float(y));
+		left.push_back(float(x - width));
+		left.push_back(float(y));
+	}
+	std::vector<float> xy(right);
+	for (std::size_t i = left.size(); i > 0; i -= 2) {
+		xy.push_back(left[i - 2]);
+		xy.push_back(left[i - 1]);
+	}
+	return make_cw(xy);
+}
+
+//! Square with every side split into collinear vertices, every other one moved inwards by a tiny
+//! amount. Orientation tests are close to zero and many vertices share their x coordinate.
+inline std::vector<float> degenerate(const unsigned n, const uint64_t seed) {
+	Random random(seed);
+	const unsigned side = std::max(1u, n / 4);
+	const double size = 1000, step = size / side;
+	std::vector<float> xy;
+	auto push = [&xy, &random](const double x, const double y, const double dx, const double dy,
+														 const bool moved) {
+		const double eps = moved ? 1e-3 * (0.5 + random.uniform()) : 0;
+		xy.push_back(float(x + eps * dx));
+		xy.push_back(float(y + eps * dy));
+	};
+	// Clockwise in y-up: up the left side, right along the top, down the right, left along the bottom
+	for (unsigned i = 0; i < side; ++i)
+		push(0, i * step, 1, 0, i % 2);
+	for (unsigned i = 0; i < side; ++i)
+		push(i * step, size, 0, -1, i % 2);
+	for (unsigned i = 0; i < side; ++i)
+		push(size, size - i * step, -1, 0, i % 2);
+	for (unsigned i = 0; i < side; ++i)
+		push(size - i * step, 0, 0, 1, i % 2);
+	return make_cw(xy);
+}
+
+//! Square with a grid of jittered diamond holes, up to n vertices in all. Every hole adds a start, a
+//! split, a merge and a stop vertex. The index of the first vertex of each hole is written to
+//! starts, see fmt::Polygon::set_holes.
+inline std::vector<float> holes(const unsigned n, const uint64_t seed,
+																std::vector<unsigned>& starts) {
+	Random random(seed);
+	const unsigned k = std::max(1u, unsigned(std::sqrt((std::max(n, 8u) - 4) / 4.0)));
+	const float size = float(10 * k);
+	std::vector<float> xy = {0, 0, 0, size, size, size, size, 0};
+	starts.clear();
+	for (unsigned i = 0; i < k; ++i)
+		for (unsigned j = 0; j < k; ++j) {
+			const double x = 10 * i + 5 + 2 * random.uniform() - 1,
+									 y = 10 * j + 5 + 2 * random.uniform() - 1;
+			const double w = 2 + 2 * random.uniform(), h = 2 + 2 * random.uniform(),
+									 tilt = random.uniform() - 0.5;
+			// Counter-clockwise: left, bottom, right, top
+			const float diamond[] = {float(x - w), float(y),        float(x), float(y - h),
+															 float(x + w), float(y + tilt), float(x), float(y + h)};
+			starts.push_back(unsigned(xy.size() / 2));
+			xy.insert(xy.end(), diamond, diamond + 8);
+		}
+	return xy;
+}
+
+//! A named generator
+struct Generator {
+	const char* name;
+	std::vector<float> (*generate)(unsigned, uint64_t);
+};
+
+//! All generators, in the order they are benchmarked
+inline const std::vector<Generator>& generators() {
+	static const std::vector<Generator> all = {{"star", star},     {"spiral", spiral},
+																						 {"comb", comb},     {"grid", grid},
+																						 {"zigzag", zigzag}, {"degenerate", degenerate}};
+	return all;
+}
+} // namespace bench
+#endif
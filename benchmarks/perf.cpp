@@ -0,0 +1,179 @@
+/* Dependency-free benchmark of FastMono on seeded polygons, see ./generators.hpp.
+ *
+ * Times every stage of the triangulation separately through the statistics of fmt::Workspace, so it
+ * must be built with FMT_INSTRUMENT defined. Polygons are generated once per size, outside of the
+ * timed loop. Each case runs at least MIN_REPS times and until MIN_SECONDS have passed, and reports
+ * the median of every stage, the heap allocations per call once the workspace has grown, and the
+ * throughput in vertices per second. Sizes grow tenfold up to max_n, and the growth of the total
+ * time over the previous size is printed, which stays close to 10x as long as every stage takes
+ * Θ(n log n). A square with many holes follows the generators. Results are written as CSV, one row
+ * per generator and size.
+ *
+ * Usage: perf [output.csv] [seed] [max_n]
+ */
+
+#ifndef FMT_INSTRUMENT
+#	error "The benchmark reads the stage timings of the workspace. Define FMT_INSTRUMENT."
+#endif
+
+#include "generators.hpp"
+
+#include "../polygon.hpp" // FastMono interface
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+// Count heap allocations by replacing the global allocation functions
+static std::atomic<uint64_t> allocations(0), allocated_bytes(0);
+
+void* operator new(std::size_t size) {
+	allocations.fetch_add(1, std::memory_order_relaxed);
+	allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+	if (void* ptr = std::malloc(size ? size : 1)) return ptr;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+	std::free(ptr);
+}
+
+using namespace std;
+
+typedef unsigned int T_ind;
+typedef chrono::steady_clock Clock;
+
+constexpr unsigned MIN_REPS = 3, MAX_REPS = 1000;
+constexpr double MIN_SECONDS = 0.5;
+
+//! Median of a vector of durations in nanoseconds
+uint64_t median(vector<uint64_t> values) {
+	sort(values.begin(), values.end());
+	return values[values.size() / 2];
+}
+
+int main(int argc, char* argv[]) {
+	const char* filename = argc < 2 ? "perf.csv" : argv[1];
+	const uint64_t seed = argc < 3 ? 1 : stoull(argv[2]);
+	const unsigned max_n = argc < 4 ? 100000 : unsigned(stoul(argv[3]));
+
+	ofstream csv(filename);
+	if (!csv) {
+		cerr << "Cannot open " << filename << " for writing." << endl;
+		return 1;
+	}
+	csv << "generator,n,seed,reps,total_ns,events_ns,sort_ns,locate_ns,sweep_ns,triangulate_ns,"
+				 "allocations,allocated_bytes,vertices_per_second"
+			<< endl;
+	cout << "Writing results to " << filename
+			 << (argc < 2 ? " (pass filename as argument to change)" : "") << endl
+			 << "Times are medians in microseconds." << endl
+			 << endl;
+
+	const char* stage_names[fmt::STAGE_COUNT] = {"events", "sort", "locate", "sweep", "triangulate"};
+	printf("%-10s %8s %5s %10s", "generator", "n", "reps", "total");
+	for (unsigned s = 0; s < fmt::STAGE_COUNT; ++s)
+		printf(" %10s", stage_names[s]);
+	printf(" %8s %12s %7s\n", "allocs", "verts/s", "growth");
+
+	// Time one polygon, with the first vertex of each hole in holes. Returns the median total time,
+	// or 0 if the triangulation failed.
+	auto run = [&](const char* name, const vector<float>& xy, const vector<T_ind>& holes) {
+		const T_ind n = T_ind(xy.size() / 2);
+		const T_ind triangles = n - 2 + 2 * T_ind(holes.size());
+
+		fmt::Polygon<float, T_ind> poly;
+		fmt::Workspace<float, T_ind> ws;
+		vector<T_ind> out(3 * triangles);
+
+		// Warm up, so that the workspace has grown, and check the result
+		poly.set_vertices(xy.data(), n);
+		poly.set_holes(holes);
+		if (poly.get_indices(out.data(), ws) != 3 * triangles) {
+			cerr << "Triangulation of " << name << " with " << n << " vertices failed." << endl;
+			return uint64_t(0);
+		}
+
+		// Reserve the results up front, so that only the triangulation allocates
+		vector<uint64_t> totals, stages[fmt::STAGE_COUNT];
+		totals.reserve(MAX_REPS);
+		for (unsigned s = 0; s < fmt::STAGE_COUNT; ++s)
+			stages[s].reserve(MAX_REPS);
+		const uint64_t allocations_before = allocations, bytes_before = allocated_bytes;
+		const Clock::time_point begin = Clock::now();
+		unsigned reps = 0;
+		auto elapsed = [&begin]() { return chrono::duration<double>(Clock::now() - begin).count(); };
+		while (reps < MIN_REPS || (reps < MAX_REPS && elapsed() < MIN_SECONDS)) {
+			poly.set_vertices(xy.data(), n);
+			poly.set_holes(holes);
+			ws.reset_stats();
+
+			const Clock::time_point start = Clock::now();
+			poly.get_indices(out.data(), ws);
+			totals.push_back(
+					uint64_t(chrono::duration_cast<chrono::nanoseconds>(Clock::now() - start).count()));
+
+			for (unsigned s = 0; s < fmt::STAGE_COUNT; ++s)
+				stages[s].push_back(ws.get_stats().nanoseconds[s]);
+			++reps;
+		}
+		const uint64_t allocs = (allocations - allocations_before) / reps,
+									 bytes = (allocated_bytes - bytes_before) / reps;
+
+		const uint64_t total = median(totals);
+		const double throughput = total ? n * 1e9 / total : 0;
+
+		csv << name << "," << n << "," << seed << "," << reps << "," << total;
+		for (unsigned s = 0; s < fmt::STAGE_COUNT; ++s)
+			csv << "," << median(stages[s]);
+		csv << "," << allocs << "," << bytes << "," << uint64_t(throughput) << endl;
+
+		printf("%-10s %8u %5u %10.1f", name, n, reps, total / 1e3);
+		for (unsigned s = 0; s < fmt::STAGE_COUNT; ++s)
+			printf(" %10.1f", median(stages[s]) / 1e3);
+		printf(" %8llu %12.3g", (unsigned long long) allocs, throughput);
+		return total;
+	};
+	// Growth of the total time over the previous size
+	auto growth = [](const uint64_t total, const uint64_t previous) {
+		if (previous)
+			printf(" %6.1fx\n", double(total) / previous);
+		else
+			printf(" %7s\n", "-");
+	};
+
+	const vector<T_ind> no_holes;
+	for (auto&& gen = bench::generators().cbegin(); gen != bench::generators().cend(); ++gen) {
+		uint64_t previous = 0;
+		for (unsigned size = 100; size <= max_n; size *= 10) {
+			const uint64_t total = run(gen->name, gen->generate(size, seed), no_holes);
+			if (!total) return 1;
+			growth(total, previous);
+			previous = total;
+		}
+	}
+
+	// Many holes, every one of which adds events to the sweep
+	vector<T_ind> holes;
+	uint64_t previous = 0;
+	for (unsigned size = 100; size <= max_n; size *= 10) {
+		const vector<float> xy = bench::holes(size, seed, holes);
+		const uint64_t total = run("holes", xy, holes);
+		if (!total) return 1;
+		growth(total, previous);
+		previous = total;
+	}
+	return 0;
+}
@@ -0,0 +1,224 @@
+/* Regression checks for fixed bugs, run through ctest. Returns non-zero if any check fails.
+ */
+
+#include "generators.hpp"
+
+#include "../parallel.hpp"
+#include "../polygon.hpp" // FastMono interface
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+typedef uint32_t T_ind;
+
+//! Whether indices form n - 2 proper triangles which use every vertex of a polygon
+bool is_complete(const fmt::Polygon<float, T_ind>& poly, const vector<T_ind>& indices) {
+	if (indices.size() != 3 * (poly.size() - 2)) return false;
+	vector<bool> used(poly.size(), false);
+	for (size_t i = 0; i < indices.size(); i += 3) {
+		const T_ind a = indices[i], b = indices[i + 1], c = indices[i + 2];
+		if (a >= poly.size() || b >= poly.size() || c >= poly.size() || a == b || b == c || a == c)
+			return false;
+		used[a] = used[b] = used[c] = true;
+	}
+	for (size_t i = 0; i < used.size(); ++i)
+		if (!used[i]) return false;
+	return true;
+}
+
+//! Appending a vertex to an incremental polygon next to the head of a part must add it to the part
+bool append_next_to_head() {
+	bool ok = true;
+	const vector<float> pentagon = {129, 404, 775, 988, 686, 503, 556, 274, 506, 707};
+	fmt::Polygon<float, T_ind> poly(pentagon);
+	poly.set_incremental(true);
+	poly.get_indices();
+	poly.push_back((506 + 129) / 2.f, (707 + 404) / 2.f);
+	if (!is_complete(poly, poly.get_indices())) {
+		cerr << "append_next_to_head: pentagon lost the appended vertex" << endl;
+		ok = false;
+	}
+
+	// Append on the closing edge of random polygons, which often joins a part at its head
+	bench::Random random(1);
+	for (uint64_t seed = 0; seed < 1000; ++seed) {
+		const vector<float> xy = bench::star(5 + random.below(20), seed);
+		const size_t n = xy.size() / 2;
+		fmt::Polygon<float, T_ind> star(xy);
+		star.set_incremental(true);
+		star.get_indices();
+		star.push_back((xy[0] + xy[2 * n - 2]) / 2, (xy[1] + xy[2 * n - 1]) / 2);
+		if (!is_complete(star, star.get_indices())) {
+			cerr << "append_next_to_head: star with seed " << seed << " lost the appended vertex"
+					 << endl;
+			ok = false;
+		}
+	}
+	return ok;
+}
+
+//! Every generator must give simple polygons for any n, as corpus generate takes n from the user
+bool small_generators() {
+	bool ok = true;
+	for (auto&& gen = bench::generators().cbegin(); gen != bench::generators().cend(); ++gen)
+		for (unsigned n = 3; n <= 64; ++n)
+			for (uint64_t seed = 0; seed < 4; ++seed) {
+				fmt::Polygon<float, T_ind> poly(gen->generate(n, seed));
+				bool complete = false;
+				try {
+					complete = is_complete(poly, poly.get_indices());
+				} catch (const std::exception&) {
+				}
+				if (!complete) {
+					cerr << "small_generators: " << gen->name << " with n " << n << " and seed " << seed
+							 << " is not simple" << endl;
+					ok = false;
+				}
+			}
+	return ok;
+}
+
+//! A parallel_for nested in another one finds the thread pool busy and must start its own threads
+bool nested_parallel_for() {
+	const T_ind outer = 8, inner = 1000;
+	vector<uint64_t> sums(outer, 0);
+	fmt::_::parallel_for(outer, T_ind(1), 4, [&sums](const T_ind begin, const T_ind end, unsigned) {
+		for (T_ind i = begin; i < end; ++i) {
+			std::atomic<uint64_t> sum(0);
+			fmt::_::parallel_for(inner, T_ind(16), 4, [&sum](const T_ind b, const T_ind e, unsigned) {
+				for (T_ind k = b; k < e; ++k)
+					sum += k;
+			});
+			sums[i] = sum;
+		}
+	});
+	for (T_ind i = 0; i < outer; ++i)
+		if (sums[i] != uint64_t(inner) * (inner - 1) / 2) {
+			cerr << "nested_parallel_for: inner loop " << i << " summed to " << sums[i] << endl;
+			return false;
+		}
+	return true;
+}
+
+//! Twice the area covered by triangles
+double covered_area2(const vector<float>& xy, const vector<T_ind>& indices) {
+	double sum = 0;
+	for (size_t i = 0; i < indices.size(); i += 3) {
+		const T_ind a = indices[i], b = indices[i + 1], c = indices[i + 2];
+		sum += abs((double(xy[2 * b]) - xy[2 * a]) * (double(xy[2 * c + 1]) - xy[2 * a + 1]) -
+							 (double(xy[2 * c]) - xy[2 * a]) * (double(xy[2 * b + 1]) - xy[2 * a + 1]));
+	}
+	return sum;
+}
+
+//! Partitioning in slabs must give the parts of the single sweep in the same order, for any number
+//! of threads and slabs
+bool slabs_match_sweep() {
+	bool ok = true;
+	auto check = [&ok](const char* name, const vector<float>& xy, const vector<T_ind>& holes,
+										 const unsigned threads, const T_ind slab_events) {
+		fmt::Workspace<float, T_ind> ws;
+		vector<T_ind> serial, slabs;
+		for (vector<T_ind>* indices : {&serial, &slabs}) {
+			fmt::Polygon<float, T_ind> poly(xy, holes);
+			indices->resize(3 * poly.triangle_count());
+			const vector<fmt::MonoPart<T_ind>>& parts = indices == &serial
+																										 ? poly.partition(ws)
+																										 : poly.partition_slabs(ws, threads, slab_events);
+			indices->resize(poly.triangulate(parts, indices->data(), ws));
+		}
+		const double area = covered_area2(xy, serial);
+		if (slabs.size() != serial.size() || abs(covered_area2(xy, slabs) - area) > 1e-9 * area) {
+			cerr << "slabs_match_sweep: " << name << " with n " << xy.size() / 2 << " gave "
+					 << slabs.size() / 3 << " triangles in slabs of " << slab_events << " events, not "
+					 << serial.size() / 3 << endl;
+			ok = false;
+		} else if (slabs != serial) {
+			cerr << "slabs_match_sweep: " << name << " with n " << xy.size() / 2 << " gave other indices"
+					 << " in slabs of " << slab_events << " events" << endl;
+			ok = false;
+		}
+	};
+
+	const vector<T_ind> no_holes;
+	for (auto&& gen = bench::generators().cbegin(); gen != bench::generators().cend(); ++gen)
+		for (unsigned n = 3; n <= 3000; n = n < 64 ? n + 1 : n * 2)
+			for (uint64_t seed = 0; seed < 2; ++seed) {
+				const vector<float> xy = gen->generate(n, seed);
+				check(gen->name, xy, no_holes, 1, 4);
+				check(gen->name, xy, no_holes, 3, 64);
+			}
+	vector<T_ind> holes;
+	for (unsigned n = 8; n <= 3000; n *= 2) {
+		const vector<float> xy = bench::holes(n, 1, holes);
+		check("holes", xy, holes, 1, 4);
+		check("holes", xy, holes, 3, 64);
+	}
+	return ok;
+}
+
+//! Strips joined across monotone parts must decode to the triangles of get_indices, each once and
+//! in clockwise orientation
+bool strips_match_indices() {
+	bool ok = true;
+	// Rotate a triangle to start at its lowest vertex, keeping its orientation
+	auto canonical = [](const T_ind a, const T_ind b, const T_ind c) {
+		const T_ind low = min(a, min(b, c));
+		return low == a ? array<T_ind, 3>{a, b, c}
+										: low == b ? array<T_ind, 3>{b, c, a} : array<T_ind, 3>{c, a, b};
+	};
+	auto check = [&](const char* name, fmt::Polygon<float, T_ind>& poly) {
+		vector<uint16_t> strips;
+		poly.get_strips(strips);
+		const vector<T_ind>& indices = poly.get_indices();
+
+		vector<array<T_ind, 3>> listed, decoded;
+		for (size_t i = 0; i < indices.size(); i += 3)
+			listed.push_back(canonical(indices[i], indices[i + 1], indices[i + 2]));
+		for (size_t i = 0, first = 0; i + 2 < strips.size(); ++i) {
+			const T_ind a = strips[i], b = strips[i + 1], c = strips[i + 2];
+			if (c == 0xffff) first = i + 3;
+			if (a == 0xffff || b == 0xffff || c == 0xffff || a == b || b == c || a == c) continue;
+			decoded.push_back((i - first) % 2 ? canonical(b, a, c) : canonical(a, b, c));
+		}
+		sort(listed.begin(), listed.end());
+		sort(decoded.begin(), decoded.end());
+		if (listed != decoded) {
+			cerr << "strips_match_indices: " << name << " with n " << poly.size()
+					 << " gave other triangles in strips" << endl;
+			ok = false;
+		}
+	};
+
+	for (auto&& gen = bench::generators().cbegin(); gen != bench::generators().cend(); ++gen)
+		for (unsigned n = 3; n <= 3000; n = n < 64 ? n + 1 : n * 2) {
+			fmt::Polygon<float, T_ind> poly(gen->generate(n, 1));
+			check(gen->name, poly);
+		}
+	vector<T_ind> holes;
+	for (unsigned n = 8; n <= 3000; n *= 2) {
+		const vector<float> xy = bench::holes(n, 1, holes);
+		fmt::Polygon<float, T_ind> poly(xy, holes);
+		check("holes", poly);
+	}
+	return ok;
+}
+
+int main() {
+	bool ok = true;
+	ok &= append_next_to_head();
+	ok &= small_generators();
+	ok &= nested_parallel_for();
+	ok &= slabs_match_sweep();
+	ok &= strips_match_indices();
+	cout << (ok ? "All regression checks passed." : "Regression checks failed.") << endl;
+	return ok ? 0 : 1;
+}
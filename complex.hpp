@@ -0,0 +1,230 @@
+#ifndef FMT_COMPLEX_H
+#define FMT_COMPLEX_H
+
+/* Defines the interface triangulating complex (self-intersecting) polygons under a fill rule */
+
+#include "partition.hpp"
+
+#include <cstdint>
+#include <map>
+#include <set>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace fmt {
+
+//! Rule deciding which regions of a complex polygon are filled, see fmt::ComplexTriangulator
+enum FillRule : uint_fast8_t {
+	EVEN_ODD = 1, //!< Regions with an odd winding number are filled
+	NON_ZERO = 2  //!< Regions with a winding number other than zero are filled
+};
+
+// Detail namespace
+namespace _ {
+/*! Edge of a complex polygon during the intersection sweep. Not meant for external use.
+
+	The remaining part of the edge runs from the last vertex passed to the right end of the edge,
+	and is cut again at every intersection.
+*/
+template<class T_ind>
+struct SweepEdge {
+	T_ind left;    //!< Vertex starting the edge in sweep order
+	T_ind last;    //!< Last vertex passed, equal to right once the edge has ended
+	T_ind right;   //!< Vertex ending the edge in sweep order
+	int wind;      //!< Sum over the input edges it stands for: 1 if in sweep order, else -1
+	int above;     //!< Winding number of the region directly above the edge
+	T_ind stamp;   //!< Last event the edge was collected at
+	bool boundary; //!< Whether the edge separates filled from empty regions
+	T_ind lower;   //!< For a boundary edge below a filled region, the piece of it along the edge
+	T_ind upper;   //!< Piece of the region above a pending merge vertex, else equal to lower
+
+	SweepEdge(const T_ind left, const T_ind right, const int wind)
+			: left(left), last(left), right(right), wind(wind), above(0), stamp(null_index<T_ind>()),
+				boundary(false), lower(null_index<T_ind>()), upper(null_index<T_ind>()) {}
+};
+
+/*! Monotone piece of a complex polygon being triangulated. Not meant for external use.
+
+	Holds the reflex chain of vertices which could not be cut off yet as a stack linked through
+	ComplexTriangulator::chain_downs, see Polygon::triangulate_part.
+*/
+template<class T_ind>
+struct SweepPiece {
+	T_ind top;     //!< Node of the last vertex added, which is on top of the stack
+	bool on_upper; //!< Whether all but the first vertex of the stack are on the upper chain
+};
+} // namespace _
+
+/*! Triangulates complex polygons, i.e. polygons whose edges may intersect.
+
+	A complex polygon consists of any number of contours in any orientation, such as the subpaths of
+	a vector graphics path. Which regions it covers is decided by a fill rule on the winding number
+	of each region, as in SVG or PostScript fills. This is meant for fill tessellation: the result
+	covers the filled area exactly, but is not a constrained triangulation of the input edges.
+
+	Intersections are resolved by a single x-sweep over all edges in the manner of Bentley and
+	Ottmann. Edges are cut at the points where they cross or touch, and the winding number of the
+	regions between them is tracked along the sweep. The edges separating filled from empty regions
+	bound the filled area. In the same sweep, it is partitioned into monotone pieces by diagonals to
+	the last vertex swept in a region, as in fmt::Polygon::partition, and each piece is triangulated
+	as its vertices are swept. Regions touching in a vertex need no special care, as the sweep meets
+	every point once. This takes Θ((n + k) log n) for n vertices and k intersections.
+
+	Intersections are computed in floating point and snapped to the sweep order. Near-degenerate
+	input, e.g. three edges crossing in almost the same point, may give triangles of no area.
+
+	All memory is kept between calls; once it has grown to fit the largest polygon, triangulating
+	further polygons allocates only for the event queue and the sweep status. A triangulator must
+	not be used by two calls at the same time.
+
+	@tparam T_vert numeric floating-point type of a coordinate component, e.g. float. Intersections
+	of integral coordinates are not representable.
+	@tparam T_ind numeric type of an index, e.g. uint_fast32_t
+*/
+template<class T_vert, class T_ind>
+class ComplexTriangulator {
+	static_assert(std::is_floating_point<T_vert>::value,
+								"Complex polygons need floating-point coordinates for their intersections.");
+
+private:
+	//! Orders the edges crossing the sweep from bottom to top. See ComplexTriangulator::is_below.
+	struct EdgeOrder {
+		const ComplexTriangulator* self;
+		bool operator()(const T_ind a, const T_ind b) const { return self->is_below(a, b); }
+	};
+
+	typedef std::pair<T_vert, T_vert> Point; //!< Orders lexicographically, as _::is_before does
+	typedef std::set<T_ind, EdgeOrder> Status;
+
+	FillRule rule; //!< Fill rule to apply
+
+	std::vector<T_vert> xs, ys; //!< Coordinates of the input vertices followed by the intersections
+	std::vector<T_ind> canon;   //!< First input vertex at the point of each input vertex
+
+	std::map<Point, T_ind> events; //!< Vertices not yet swept, in sweep order
+
+	std::vector<_::SweepEdge<T_ind>> edges; //!< All edges, ordered by their left vertex
+	std::vector<T_ind> edge_offsets;        //!< First edge starting at each input vertex
+
+	std::vector<T_ind> pass_heads; //!< First edge to collect at each vertex
+	std::vector<T_ind> pass_edges; //!< Edges to collect, linked by pass_nexts
+	std::vector<T_ind> pass_nexts; //!< Links of the lists of edges to collect
+
+	Status status;                                       //!< Edges crossing the sweep
+	Status bound_status;                                 //!< Boundary edges crossing the sweep
+	std::vector<typename Status::iterator> positions;    //!< Position of each edge in status
+	std::vector<typename Status::iterator> bound_positions; //!< Position in bound_status
+	std::vector<T_ind> group;                            //!< Edges collected at the current event
+	std::vector<T_ind> lefts; //!< Lower and upper pieces above each boundary edge ending at the event
+	T_vert sweep_x = T_vert(0), sweep_y = T_vert(0);     //!< The current event
+	T_vert tolerance = T_vert(0); //!< Distance within which an edge is taken to pass an event
+
+	std::vector<_::SweepPiece<T_ind>> pieces; //!< Monotone pieces of the filled region
+	std::vector<T_ind> chain_verts;           //!< Vertex of each node of the stacks of the pieces
+	std::vector<T_ind> chain_downs;           //!< Node below each node, or null_index at the bottom
+	std::vector<T_ind>* out = nullptr;        //!< Indices written to
+
+	//! Get the height of the remaining part of an edge at the sweep. Vertical edges are clamped to
+	//! the sweep, as the sweep line is rotated by an infinitesimal angle, see _::is_before.
+	//! null_index stands for the current event itself.
+	T_vert sweep_y_of(const T_ind edge) const;
+
+	//! Whether an edge lies below another at the sweep, or starts below it at the current event
+	bool is_below(const T_ind a, const T_ind b) const;
+
+	//! Get the vertex at a point, creating an event if there is none
+	T_ind vertex_at(const T_vert x, const T_vert y);
+
+	//! Collect an edge at the event of a vertex
+	void pass(const T_ind vert, const T_ind edge);
+
+	//! Check two edges adjacent in the status for an intersection right of the sweep
+	void check(const T_ind a, const T_ind b);
+
+	//! Sweep the event of a vertex
+	void sweep(const T_ind vert);
+
+	//! Update the pieces of the filled regions around a vertex, given the boundary edge below it in
+	//! bound_status and the number of boundary edges starting at it, which follow that edge. The
+	//! pieces above the boundary edges ending at it are in lefts.
+	void split_regions(const T_ind vert, const typename Status::iterator below, const T_ind count);
+
+	//! Whether the fill rule fills a region with the given winding number
+	bool is_filled(const int winding) const {
+		return rule == EVEN_ODD ? winding % 2 != 0 : winding != 0;
+	}
+
+	//! Start a new piece at its leftmost vertex
+	T_ind start_piece(const T_ind vert);
+
+	//! Add the next vertex on either chain to a piece, cutting off triangles where possible
+	void add_vertex(const T_ind piece, const T_ind vert, const bool is_upper);
+
+	//! Close a piece at its rightmost vertex
+	void close_piece(const T_ind piece, const T_ind vert);
+
+	//! Add a vertex to a region on its lower or upper side. Resolves a pending merge vertex by
+	//! closing the piece on the other side of the diagonal to the vertex.
+	void reach_region(T_ind& lower, T_ind& upper, const T_ind vert, const bool is_upper);
+
+	//! Emit a triangle in clockwise orientation, see Polygon::push_triangle
+	void push_triangle(const T_ind a, const T_ind b, const T_ind c, const bool on_upper) {
+		out->push_back(a);
+		out->push_back(on_upper ? b : c);
+		out->push_back(on_upper ? c : b);
+	}
+
+public:
+	/*! Construct a new complex triangulator.
+
+		@param rule Fill rule to apply. Defaults to NON_ZERO.
+	*/
+	ComplexTriangulator(const FillRule rule = NON_ZERO);
+
+	ComplexTriangulator(const ComplexTriangulator&) = delete;
+	ComplexTriangulator& operator=(const ComplexTriangulator&) = delete;
+
+	//! Set the fill rule to apply
+	void set_fill_rule(const FillRule rule) { this->rule = rule; }
+	//! Get the fill rule applied
+	FillRule get_fill_rule() const { return rule; }
+
+	/*! Triangulate a complex polygon.
+
+		@param coords Interleaved x and y coordinates of the vertices of all contours.
+		@param offsets Array of count + 1 vertex offsets. Contour i consists of the vertices
+		offsets[i] to offsets[i + 1] - 1 and is closed implicitly. offsets[0] is usually 0.
+		@param count Number of contours.
+		@param vertices Output. Overwritten with the interleaved coordinates of the input vertices
+		from offsets[0] on, followed by the intersections added.
+		@param indices Output. Overwritten with the indices of the triangles covering the filled
+		region, into vertices. Triangles are in clockwise orientation.
+
+		@throws std::invalid_argument If the offsets decrease.
+	*/
+	void triangulate(const T_vert* coords, const T_ind* offsets, const T_ind count,
+									 std::vector<T_vert>& vertices, std::vector<T_ind>& indices);
+};
+
+/*! Triangulate a complex polygon with a single contour.
+
+	Convenience function constructing a temporary fmt::ComplexTriangulator. To reuse its memory,
+	keep a ComplexTriangulator instead. See fmt::ComplexTriangulator::triangulate for the
+	parameters.
+
+	@param vec Interleaved x and y coordinates of the contour.
+	@param rule Fill rule to apply. Defaults to NON_ZERO.
+*/
+template<class T_vert, class T_ind>
+void triangulate_complex(const std::vector<T_vert>& vec, std::vector<T_vert>& vertices,
+												 std::vector<T_ind>& indices, const FillRule rule = NON_ZERO) {
+	const T_ind offsets[2] = {T_ind(0), T_ind(vec.size() / 2)};
+	ComplexTriangulator<T_vert, T_ind>(rule).triangulate(vec.data(), offsets, T_ind(1), vertices,
+																											 indices);
+}
+} // namespace fmt
+
+#include "complex.ipp"
+
+#endif
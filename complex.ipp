@@ -0,0 +1,458 @@
+#ifndef FMT_COMPLEX_IPP
+#define FMT_COMPLEX_IPP
+
+/* Implements the intersection sweep triangulating complex polygons */
+
+#include "complex.hpp"
+#include "partition.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <limits>
+
+#ifndef FMT_NOEXCEPT
+#	include <stdexcept>
+#endif
+
+template<class T_vert, class T_ind>
+fmt::ComplexTriangulator<T_vert, T_ind>::ComplexTriangulator(const FillRule rule)
+		: rule(rule), status(EdgeOrder{this}), bound_status(EdgeOrder{this}) {}
+
+template<class T_vert, class T_ind>
+T_vert fmt::ComplexTriangulator<T_vert, T_ind>::sweep_y_of(const T_ind edge) const {
+	if (edge == _::null_index<T_ind>()) return sweep_y;
+
+	const T_ind l = edges[edge].last, r = edges[edge].right;
+	if (xs[l] == xs[r]) return std::max(ys[l], std::min(sweep_y, ys[r]));
+	if (xs[l] == sweep_x) return ys[l];
+	if (xs[r] == sweep_x) return ys[r];
+	return ys[l] + (ys[r] - ys[l]) * (sweep_x - xs[l]) / (xs[r] - xs[l]);
+}
+
+template<class T_vert, class T_ind>
+bool fmt::ComplexTriangulator<T_vert, T_ind>::is_below(const T_ind a, const T_ind b) const {
+	const T_vert y_a = sweep_y_of(a), y_b = sweep_y_of(b);
+	if (y_a != y_b) return y_a < y_b;
+	if (a == b || a == _::null_index<T_ind>() || b == _::null_index<T_ind>()) return false;
+
+	// Edges meeting at the sweep are ordered by the direction they leave in. A vertical edge leaves
+	// upwards and lies above all others.
+	const _::SweepEdge<T_ind>&e_a = edges[a], &e_b = edges[b];
+	const T_vert turn = (xs[e_a.right] - xs[e_a.last]) * (ys[e_b.right] - ys[e_b.last]) -
+											(ys[e_a.right] - ys[e_a.last]) * (xs[e_b.right] - xs[e_b.last]);
+	if (turn != 0) return turn > 0;
+	return a < b; // overlapping edges
+}
+
+template<class T_vert, class T_ind>
+T_ind fmt::ComplexTriangulator<T_vert, T_ind>::vertex_at(const T_vert x, const T_vert y) {
+	auto&& it = events.emplace(Point(x, y), T_ind(xs.size()));
+	if (it.second) {
+		xs.push_back(x);
+		ys.push_back(y);
+		pass_heads.push_back(_::null_index<T_ind>());
+	}
+	return it.first->second;
+}
+
+template<class T_vert, class T_ind>
+void fmt::ComplexTriangulator<T_vert, T_ind>::pass(const T_ind vert, const T_ind edge) {
+	pass_edges.push_back(edge);
+	pass_nexts.push_back(pass_heads[vert]);
+	pass_heads[vert] = pass_edges.size() - 1;
+}
+
+template<class T_vert, class T_ind>
+void fmt::ComplexTriangulator<T_vert, T_ind>::check(const T_ind a, const T_ind b) {
+	const T_ind p = edges[a].last, r = edges[a].right;
+	const T_ind q = edges[b].last, s = edges[b].right;
+
+	// Side of the vertices of either edge relative to the other one
+	auto side = [this](const T_ind from, const T_ind to, const T_ind vert) {
+		return _::orientation(xs[from], ys[from], xs[to], ys[to], xs[vert], ys[vert]);
+	};
+	const int side_q = side(p, r, q), side_s = side(p, r, s);
+	const int side_p = side(q, s, p), side_r = side(q, s, r);
+
+	auto before = [this](const T_ind u, const T_ind v) {
+		return _::is_before(xs[u], ys[u], xs[v], ys[v]);
+	};
+
+	// Proper crossing. The point is computed from the whole edges in a fixed order, so that the
+	// same crossing found again after cutting either edge yields the same vertex. Parallel edges
+	// only seem to cross where they overlap and were cut at rounded points.
+	const T_ind e_a = std::min(a, b), e_b = std::max(a, b);
+	const T_ind p0 = edges[e_a].left, r0 = edges[e_a].right;
+	const T_ind q0 = edges[e_b].left, s0 = edges[e_b].right;
+	const T_vert dx_a = xs[r0] - xs[p0], dy_a = ys[r0] - ys[p0];
+	const T_vert dx_b = xs[s0] - xs[q0], dy_b = ys[s0] - ys[q0];
+	const T_vert denom = dx_a * dy_b - dy_a * dx_b;
+	if (side_q * side_s < 0 && side_p * side_r < 0 && denom != T_vert(0)) {
+		// The point is clamped to both edges to stay in sweep order
+		const T_vert t = ((xs[q0] - xs[p0]) * dy_b - (ys[q0] - ys[p0]) * dx_b) / denom;
+		T_vert x = xs[p0] + t * dx_a, y = ys[p0] + t * dy_a;
+		x = std::min(std::max(x, std::max(xs[p0], xs[q0])), std::min(xs[r0], xs[s0]));
+		y = std::min(std::max(y, std::max(std::min(ys[p0], ys[r0]), std::min(ys[q0], ys[s0]))),
+								 std::min(std::max(ys[p0], ys[r0]), std::max(ys[q0], ys[s0])));
+		if (!_::is_before(sweep_x, sweep_y, x, y)) {
+			// Rounded onto or behind the sweep: the edges are out of order already. They are swapped
+			// right after the event, before either reaches another vertex.
+			x = sweep_x;
+			y = std::nextafter(sweep_y, std::numeric_limits<T_vert>::infinity());
+			if (!_::is_before(x, y, xs[r], ys[r]) || !_::is_before(x, y, xs[s], ys[s])) return;
+		}
+
+		const T_ind vert = vertex_at(x, y);
+		pass(vert, a);
+		pass(vert, b);
+		return;
+	}
+
+	// An edge ending on the other one cuts it
+	if (!side_s && before(p, s) && before(s, r)) pass(s, a);
+	if (!side_r && before(q, r) && before(r, s)) pass(r, b);
+}
+
+template<class T_vert, class T_ind>
+T_ind fmt::ComplexTriangulator<T_vert, T_ind>::start_piece(const T_ind vert) {
+	chain_verts.push_back(vert);
+	chain_downs.push_back(_::null_index<T_ind>());
+	pieces.push_back(_::SweepPiece<T_ind>{T_ind(chain_verts.size() - 1), true});
+	return pieces.size() - 1;
+}
+
+template<class T_vert, class T_ind>
+void fmt::ComplexTriangulator<T_vert, T_ind>::add_vertex(const T_ind piece, const T_ind vert,
+																												 const bool is_upper) {
+	// As in Polygon::triangulate_part, with the vertices arriving in sweep order
+	_::SweepPiece<T_ind>& this_piece = pieces[piece];
+	const T_ind null = _::null_index<T_ind>();
+	T_ind top = this_piece.top;
+
+	// whether the diagonal from c to a lies inside the piece, so that b can be cut off
+	auto cuts = [this](const T_ind a, const T_ind b, const T_ind c, const bool on_upper) {
+		return on_upper ? _::is_reflex(xs[c], ys[c], xs[b], ys[b], xs[a], ys[a])
+										: _::is_reflex(xs[a], ys[a], xs[b], ys[b], xs[c], ys[c]);
+	};
+
+	if (chain_downs[top] == null) {
+		this_piece.on_upper = is_upper;
+	} else if (is_upper != this_piece.on_upper) {
+		// Opposite chain: fan out to the whole reflex chain
+		for (T_ind node = top; chain_downs[node] != null; node = chain_downs[node])
+			push_triangle(chain_verts[chain_downs[node]], chain_verts[node], vert, this_piece.on_upper);
+		chain_downs[top] = null;
+		this_piece.on_upper = is_upper;
+	} else {
+		// Same chain: cut off vertices as long as the diagonal lies inside the piece
+		while (chain_downs[top] != null &&
+					 cuts(chain_verts[chain_downs[top]], chain_verts[top], vert, is_upper)) {
+			push_triangle(chain_verts[chain_downs[top]], chain_verts[top], vert, is_upper);
+			top = chain_downs[top];
+		}
+	}
+
+	chain_verts.push_back(vert);
+	chain_downs.push_back(top);
+	this_piece.top = chain_verts.size() - 1;
+}
+
+template<class T_vert, class T_ind>
+void fmt::ComplexTriangulator<T_vert, T_ind>::close_piece(const T_ind piece, const T_ind vert) {
+	const _::SweepPiece<T_ind>& this_piece = pieces[piece];
+	for (T_ind node = this_piece.top; chain_downs[node] != _::null_index<T_ind>();
+			 node = chain_downs[node])
+		push_triangle(chain_verts[chain_downs[node]], chain_verts[node], vert, this_piece.on_upper);
+}
+
+template<class T_vert, class T_ind>
+void fmt::ComplexTriangulator<T_vert, T_ind>::reach_region(T_ind& lower, T_ind& upper,
+																													 const T_ind vert, const bool is_upper) {
+	if (lower != upper) {
+		// The diagonal from the merge vertex ends the piece on the side the vertex is not on
+		close_piece(is_upper ? upper : lower, vert);
+		if (is_upper)
+			upper = lower;
+		else
+			lower = upper;
+	}
+	add_vertex(lower, vert, is_upper);
+}
+
+template<class T_vert, class T_ind>
+void fmt::ComplexTriangulator<T_vert, T_ind>::split_regions(const T_ind vert,
+																														const typename Status::iterator below,
+																														const T_ind count) {
+	const T_ind null = _::null_index<T_ind>();
+	const T_ind k = lefts.size() / 2;
+	_::SweepEdge<T_ind>* const edge_below = below == bound_status.end() ? nullptr : &edges[*below];
+
+	// Pieces of the regions right of the vertex directly above the edge below it and directly below
+	// the edge above it
+	T_ind low_lower = edge_below ? edge_below->lower : null;
+	T_ind low_upper = edge_below ? edge_below->upper : null;
+	T_ind high_lower = null, high_upper = null;
+
+	if (!k) {
+		if (!count) return; // not on a boundary
+
+		// Split vertex: the region around it is divided by a diagonal to its last vertex swept. With
+		// a merge vertex pending, that is the merge vertex and no piece is added.
+		if (low_lower == null) {
+			// start vertex: only the regions between its edges are filled
+		} else if (low_lower != low_upper) {
+			add_vertex(low_lower, vert, true);
+			add_vertex(low_upper, vert, false);
+			high_lower = high_upper = low_upper;
+			low_upper = low_lower;
+		} else {
+			const _::SweepPiece<T_ind>& piece = pieces[low_lower];
+			const bool last_upper = chain_downs[piece.top] == null || piece.on_upper;
+			const T_ind other = start_piece(chain_verts[piece.top]);
+			add_vertex(last_upper ? low_lower : other, vert, true);
+			add_vertex(last_upper ? other : low_lower, vert, false);
+			high_lower = high_upper = last_upper ? other : low_lower;
+			low_lower = low_upper = last_upper ? low_lower : other;
+		}
+	} else {
+		// Regions between the edges ending at the vertex end with it
+		for (T_ind i = T_ind(0); i + 1 < k; ++i)
+			if (lefts[2 * i] != null) {
+				close_piece(lefts[2 * i], vert);
+				if (lefts[2 * i + 1] != lefts[2 * i]) close_piece(lefts[2 * i + 1], vert);
+			}
+
+		// The regions below and above the vertex reach it
+		high_lower = lefts[2 * k - 2];
+		high_upper = lefts[2 * k - 1];
+		if (low_lower != null) reach_region(low_lower, low_upper, vert, true);
+		if (high_lower != null) reach_region(high_lower, high_upper, vert, false);
+
+		if (!count) {
+			// Merge vertex: both regions continue as one, and the vertex is connected to the next vertex
+			// swept in it
+			if (low_lower != null && high_lower != null)
+				low_upper = high_lower;
+			else if (high_lower != null) // only due to rounding
+				close_piece(high_lower, vert);
+		}
+	}
+
+	if (edge_below) {
+		edge_below->lower = low_lower;
+		edge_below->upper = low_upper;
+	}
+
+	// Regions between the edges starting at the vertex start with it
+	auto&& it = edge_below ? std::next(below) : bound_status.begin();
+	for (T_ind i = T_ind(0); i < count; ++i, ++it) {
+		_::SweepEdge<T_ind>& e = edges[*it];
+		if (i + 1 == count) {
+			e.lower = high_lower;
+			e.upper = high_upper;
+		} else {
+			e.lower = e.upper = is_filled(e.above) ? start_piece(vert) : null;
+		}
+	}
+}
+
+template<class T_vert, class T_ind>
+void fmt::ComplexTriangulator<T_vert, T_ind>::sweep(const T_ind vert) {
+	const T_ind probe = _::null_index<T_ind>();
+	group.clear();
+
+	// Collect all edges ending at or passing through the event: those found by earlier checks, and
+	// those at the height of the event in the status
+	for (T_ind it = pass_heads[vert]; it != probe; it = pass_nexts[it]) {
+		_::SweepEdge<T_ind>& e = edges[pass_edges[it]];
+		if (e.last == e.right || e.stamp == vert) continue;
+		e.stamp = vert;
+		group.push_back(pass_edges[it]);
+	}
+	auto collect = [this, vert](const T_ind edge) {
+		if (edges[edge].stamp == vert) return;
+		edges[edge].stamp = vert;
+		group.push_back(edge);
+	};
+	auto&& range = status.equal_range(probe);
+	for (auto it = range.first; it != range.second; ++it)
+		collect(*it);
+
+	// Edges passing the event closer than intersections are rounded are collected as well, so that
+	// no edge is passed by the others without being cut
+	auto passes = [this, vert](const T_ind edge) {
+		const T_ind l = edges[edge].last, r = edges[edge].right;
+		const T_vert dx = xs[r] - xs[l], dy = ys[r] - ys[l];
+		const T_vert cross = dx * (ys[vert] - ys[l]) - dy * (xs[vert] - xs[l]);
+		return std::abs(cross) <= tolerance * (std::abs(dx) + std::abs(dy));
+	};
+	for (auto it = range.first; it != status.begin() && passes(*std::prev(it)); --it)
+		collect(*std::prev(it));
+	for (auto it = range.second; it != status.end() && passes(*it); ++it)
+		collect(*it);
+
+	// The boundary edges among them are adjacent in bound_status. Take the pieces above them from
+	// bottom to top and find the boundary edge below the event.
+	lefts.clear();
+	typename Status::iterator below = bound_status.end();
+	auto&& it_bound = std::find_if(group.cbegin(), group.cend(),
+																 [this](const T_ind e) { return edges[e].boundary; });
+	if (it_bound != group.cend()) {
+		auto&& it = bound_positions[*it_bound];
+		while (it != bound_status.begin() && edges[*std::prev(it)].stamp == vert)
+			--it;
+		if (it != bound_status.begin()) below = std::prev(it);
+		while (it != bound_status.end() && edges[*it].stamp == vert) {
+			lefts.push_back(edges[*it].lower);
+			lefts.push_back(edges[*it].upper);
+			edges[*it].boundary = false;
+			it = bound_status.erase(it);
+		}
+	} else {
+		auto&& it = bound_status.lower_bound(probe);
+		if (it != bound_status.begin()) below = std::prev(it);
+	}
+
+	// Cut the collected edges at the event. Edges continuing past it are inserted anew, together
+	// with the edges starting at it, ordered by the direction they leave in.
+	auto&& it_keep = group.begin();
+	for (auto&& it = group.begin(); it != group.end(); ++it) {
+		status.erase(positions[*it]);
+		if (edges[*it].boundary) { // only due to rounding: not adjacent to the others
+			bound_status.erase(bound_positions[*it]);
+			edges[*it].boundary = false;
+		}
+		edges[*it].last = vert;
+		if (edges[*it].right != vert) *(it_keep++) = *it;
+	}
+	group.erase(it_keep, group.end());
+
+	if (vert + 1 < edge_offsets.size())
+		for (T_ind e = edge_offsets[vert]; e != edge_offsets[vert + 1]; ++e) {
+			group.push_back(e);
+			pass(edges[e].right, e);
+		}
+
+	for (auto&& it = group.begin(); it != group.end(); ++it)
+		positions[*it] = status.insert(*it).first;
+
+	range = status.equal_range(probe);
+	if (range.first == range.second) {
+		// Nothing continues: the edges around the event become adjacent
+		split_regions(vert, below, T_ind(0));
+		if (range.first != status.begin() && range.first != status.end())
+			check(*std::prev(range.first), *range.first);
+		return;
+	}
+
+	// The winding number increases by the winding of each edge upwards. Edges with a filled region
+	// on one side only are boundary edges.
+	int winding = range.first == status.begin() ? 0 : edges[*std::prev(range.first)].above;
+	auto&& above = below == bound_status.end() ? bound_status.begin() : std::next(below);
+	T_ind count = T_ind(0);
+	for (auto it = range.first; it != range.second; ++it) {
+		_::SweepEdge<T_ind>& e = edges[*it];
+		winding += e.wind;
+		e.above = winding;
+		e.boundary = is_filled(winding) != is_filled(winding - e.wind);
+		if (e.boundary) {
+			bound_positions[*it] = bound_status.insert(above, *it);
+			++count;
+		}
+	}
+	split_regions(vert, below, count);
+
+	if (range.first != status.begin()) check(*std::prev(range.first), *range.first);
+	if (range.second != status.end()) check(*std::prev(range.second), *range.second);
+}
+
+template<class T_vert, class T_ind>
+void fmt::ComplexTriangulator<T_vert, T_ind>::triangulate(const T_vert* coords, const T_ind* offsets,
+																													const T_ind count,
+																													std::vector<T_vert>& vertices,
+																													std::vector<T_ind>& indices) {
+	const T_ind first = offsets[0], n = offsets[count] - first;
+#ifndef FMT_NOEXCEPT
+	for (T_ind i = T_ind(0); i < count; ++i)
+		if (offsets[i + 1] < offsets[i]) throw std::invalid_argument("Contour offsets decrease.");
+#endif
+
+	xs.resize(n);
+	ys.resize(n);
+	T_vert extent = T_vert(0);
+	for (T_ind i = T_ind(0); i < n; ++i) {
+		xs[i] = coords[2 * (first + i)];
+		ys[i] = coords[2 * (first + i) + 1];
+		extent = std::max(extent, std::max(std::abs(xs[i]), std::abs(ys[i])));
+	}
+	tolerance = T_vert(16) * std::numeric_limits<T_vert>::epsilon() * extent;
+
+	// Merge duplicate vertices into the first of them. Each vertex is swept once.
+	events.clear();
+	pass_heads.assign(n, _::null_index<T_ind>());
+	canon.resize(n);
+	for (T_ind i = T_ind(0); i < n; ++i)
+		canon[i] = events.emplace(Point(xs[i], ys[i]), i).first->second;
+
+	// Collect the edges, ordered by their vertices. Edges running between the same vertices are
+	// merged into one carrying the sum of their windings, and dropped if that is zero.
+	edges.clear();
+	for (T_ind c = T_ind(0); c < count; ++c) {
+		const T_ind begin = offsets[c] - first, end = offsets[c + 1] - first;
+		for (T_ind i = begin; i < end; ++i) {
+			const T_ind u = canon[i], v = canon[i + 1 == end ? begin : i + 1];
+			if (u == v) continue;
+			const bool forward = _::is_before(xs[u], ys[u], xs[v], ys[v]);
+			edges.emplace_back(forward ? u : v, forward ? v : u, forward ? 1 : -1);
+		}
+	}
+	std::sort(edges.begin(), edges.end(),
+						[](const _::SweepEdge<T_ind>& a, const _::SweepEdge<T_ind>& b) {
+							return a.left < b.left || (a.left == b.left && a.right < b.right);
+						});
+
+	auto&& it_keep = edges.begin();
+	for (auto&& it = edges.begin(); it != edges.end();) {
+		*it_keep = *(it++);
+		for (; it != edges.end() && it->left == it_keep->left && it->right == it_keep->right; ++it)
+			it_keep->wind += it->wind;
+		if (it_keep->wind) ++it_keep;
+	}
+	edges.erase(it_keep, edges.end());
+
+	edge_offsets.assign(n + 1, T_ind(0));
+	for (auto&& it = edges.cbegin(); it != edges.cend(); ++it)
+		++edge_offsets[it->left + 1];
+	for (T_ind v = T_ind(0); v < n; ++v)
+		edge_offsets[v + 1] += edge_offsets[v];
+
+	// Sweep all vertices, including the intersections found on the way, and triangulate on the way
+	status.clear();
+	bound_status.clear();
+	positions.resize(edges.size());
+	bound_positions.resize(edges.size());
+	pass_edges.clear();
+	pass_nexts.clear();
+	pieces.clear();
+	chain_verts.clear();
+	chain_downs.clear();
+	out = &indices;
+	indices.clear();
+	while (!events.empty()) {
+		auto&& it = events.begin();
+		sweep_x = it->first.first;
+		sweep_y = it->first.second;
+		const T_ind vert = it->second;
+		events.erase(it);
+		sweep(vert);
+	}
+	out = nullptr;
+
+	vertices.resize(2 * xs.size());
+	for (T_ind i = T_ind(0); i < xs.size(); ++i) {
+		vertices[2 * i] = xs[i];
+		vertices[2 * i + 1] = ys[i];
+	}
+}
+#endif
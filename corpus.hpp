@@ -0,0 +1,197 @@
+#ifndef FMT_CORPUS_H
+#define FMT_CORPUS_H
+
+/* Defines a binary container for large numbers of polygons or triangulations, which is read through
+ * a memory mapping and written as a stream.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace fmt {
+
+/*! Header of a corpus file.
+
+	A corpus holds count records, each an array of items of arity values of one numeric type. A
+	polygon is a record of vertices with two coordinates each, its triangulation a record of
+	triangles with three indices each. The header is followed by an offset table of count + 1
+	entries, where record i spans items table[i] to table[i + 1] - 1, and then by the values of all
+	items back to back. The table and the values start at multiples of 64 bytes from the beginning
+	of the file, so that both may be used in place once the file is mapped into memory.
+
+	All fields are in the byte order of the machine writing the file, which is checked through the
+	magic number when reading.
+*/
+struct CorpusHeader {
+	uint32_t magic;   //!< fmt::CorpusHeader::MAGIC
+	uint32_t version; //!< fmt::CorpusHeader::VERSION
+	uint32_t type;    //!< Numeric type of the values, see fmt::CorpusType
+	uint32_t arity;   //!< Number of values per item
+	uint64_t count;   //!< Number of records
+	uint64_t items;   //!< Number of items in all records
+	uint64_t table;   //!< Position of the offset table in bytes
+	uint64_t values;  //!< Position of the first value in bytes
+
+	static constexpr uint32_t MAGIC = 0x43544d46; //!< "FMTC" in little endian
+	static constexpr uint32_t VERSION = 1;
+};
+
+//! Numeric types of the values of a corpus
+enum CorpusType : uint32_t { FLOAT32 = 1, FLOAT64 = 2, INT16 = 3, INT32 = 4, UINT16 = 5, UINT32 = 6 };
+
+namespace _ {
+//! Corpus type of a C++ type. Not meant for external use.
+template<class T>
+struct CorpusTypeOf;
+template<>
+struct CorpusTypeOf<float> {
+	static constexpr CorpusType value = FLOAT32;
+};
+template<>
+struct CorpusTypeOf<double> {
+	static constexpr CorpusType value = FLOAT64;
+};
+template<>
+struct CorpusTypeOf<int16_t> {
+	static constexpr CorpusType value = INT16;
+};
+template<>
+struct CorpusTypeOf<int32_t> {
+	static constexpr CorpusType value = INT32;
+};
+template<>
+struct CorpusTypeOf<uint16_t> {
+	static constexpr CorpusType value = UINT16;
+};
+template<>
+struct CorpusTypeOf<uint32_t> {
+	static constexpr CorpusType value = UINT32;
+};
+
+//! Round a position in a file up to the next multiple of 64 bytes
+constexpr inline uint64_t align_position(const uint64_t position) {
+	return (position + 63) / 64 * 64;
+}
+} // namespace _
+
+/*! Read-only view of a corpus file, see fmt::CorpusHeader.
+
+	On POSIX systems, the file is mapped into memory and records are returned as pointers into the
+	mapping: nothing is parsed or copied, and only the pages actually read are loaded from disk.
+	Elsewhere, the file is read into memory as a whole.
+
+	A record of polygon vertices can be passed to fmt::Polygon as a view without copying, e.g.
+	`poly.set_vertices(corpus.record(i), T_ind(corpus.length(i)))`.
+
+	@tparam T numeric type of the values. Must match the type stored in the file.
+*/
+template<class T>
+class CorpusView {
+private:
+	const unsigned char* bytes = nullptr; //!< Contents of the file
+	uint64_t file_size = 0;               //!< Size of the file in bytes
+	bool is_mapped = false;               //!< Whether bytes is a memory mapping
+	std::vector<unsigned char> buffer;    //!< Contents of the file if it could not be mapped
+
+	CorpusHeader header = CorpusHeader();
+	const uint64_t* table = nullptr; //!< Offset table of count + 1 entries
+	const T* values = nullptr;       //!< Values of all items
+
+	//! Map or read a file and check its header. Returns the reason if it cannot be used, else null.
+	const char* open(const char* path);
+	//! Release the file
+	void close();
+
+public:
+	/*! Open a corpus file.
+
+		Checks in one pass over the offset table that the records follow each other within the
+		values, so that no record read later points outside of the file.
+
+		@throws std::runtime_error If the file cannot be read, is no corpus, holds values of another
+		type, or is truncated or corrupt.
+	*/
+	explicit CorpusView(const char* path);
+	~CorpusView() { close(); }
+
+	CorpusView(const CorpusView&) = delete;
+	CorpusView& operator=(const CorpusView&) = delete;
+
+	//! Get the number of records
+	uint64_t size() const { return header.count; }
+	//! Get the number of values per item
+	unsigned arity() const { return header.arity; }
+	//! Get the number of items of all records
+	uint64_t items() const { return header.items; }
+
+	//! Get the offset table of size() + 1 entries. Record i spans items offsets()[i] to
+	//! offsets()[i + 1] - 1.
+	const uint64_t* offsets() const { return table; }
+	//! Get the values of all items, arity() per item
+	const T* data() const { return values; }
+
+	//! Get the values of record i
+	const T* record(const uint64_t i) const { return values + table[i] * header.arity; }
+	//! Get the number of items of record i
+	uint64_t length(const uint64_t i) const { return table[i + 1] - table[i]; }
+};
+
+/*! Writes a corpus file as a stream, see fmt::CorpusHeader.
+
+	The number of records must be known up front, so that the offset table can be written ahead of
+	the values while they are streamed. Memory use is bounded by a small buffer of table entries,
+	regardless of the size of the corpus.
+
+	@tparam T numeric type of the values.
+*/
+template<class T>
+class CorpusWriter {
+private:
+	std::FILE* file = nullptr;
+	CorpusHeader header = CorpusHeader();
+	uint64_t pushed = 0;             //!< Records written so far
+	std::vector<uint64_t> pending;   //!< Table entries not yet written
+	uint64_t pending_first = 0;      //!< Index of the first pending table entry
+	bool failed = false;             //!< Whether a seek failed, reported by close
+
+	//! Write the pending table entries to their place in the table
+	void flush_table();
+
+public:
+	/*! Create a corpus file, replacing any existing file.
+
+		@param path Path of the file.
+		@param arity Number of values per item, e.g. 2 for vertices or 3 for triangles.
+		@param count Number of records which will be pushed.
+
+		@throws std::runtime_error If the file cannot be created, or if the table does not fit in
+		the file offsets of the platform.
+	*/
+	CorpusWriter(const char* path, const unsigned arity, const uint64_t count);
+	//! Close the file. Errors are ignored, call close to check for them.
+	~CorpusWriter();
+
+	CorpusWriter(const CorpusWriter&) = delete;
+	CorpusWriter& operator=(const CorpusWriter&) = delete;
+
+	/*! Append a record.
+
+		@param values arity values per item, interleaved.
+		@param length Number of items of the record.
+
+		@throws std::runtime_error If more records are pushed than announced, or on a write error.
+	*/
+	void push(const T* values, const uint64_t length);
+
+	/*! Write the remaining table entries and close the file.
+
+		@throws std::runtime_error If fewer records were pushed than announced, or on a write error.
+	*/
+	void close();
+};
+} // namespace fmt
+
+#include "corpus.ipp"
+
+#endif
@@ -0,0 +1,205 @@
+#ifndef FMT_CORPUS_IPP
+#define FMT_CORPUS_IPP
+
+// Reads corpus files through a memory mapping and writes them as a stream
+
+#include "corpus.hpp"
+
+#include <climits>
+#include <cstring>
+#include <limits>
+
+#if defined(__unix__) || defined(__APPLE__)
+#	define FMT_CORPUS_MMAP
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#endif
+
+#ifndef FMT_NOEXCEPT
+#	include <stdexcept>
+#	include <string>
+#endif
+
+namespace fmt {
+
+namespace _ {
+//! Move a file to a position in bytes. Uses 64 bit offsets where the platform has them, as long
+//! only holds 2 GiB on some. Returns false if the position cannot be reached.
+inline bool seek_file(std::FILE* file, const uint64_t position) {
+#if defined(_WIN32)
+	return position <= uint64_t(std::numeric_limits<__int64>::max()) &&
+				 ::_fseeki64(file, __int64(position), SEEK_SET) == 0;
+#elif defined(__unix__) || defined(__APPLE__)
+	// off_t has 32 bits on 32 bit systems built without _FILE_OFFSET_BITS=64
+	return position <= uint64_t(std::numeric_limits<off_t>::max()) &&
+				 ::fseeko(file, off_t(position), SEEK_SET) == 0;
+#else
+	return position <= uint64_t(LONG_MAX) && std::fseek(file, long(position), SEEK_SET) == 0;
+#endif
+}
+} // namespace _
+
+template<class T>
+CorpusView<T>::CorpusView(const char* path) {
+	const char* error = open(path);
+	if (!error) return;
+	// Without exceptions, a file which cannot be read leaves an empty view
+	close();
+	header = CorpusHeader();
+#ifndef FMT_NOEXCEPT
+	throw std::runtime_error(std::string(path) + ": " + error);
+#endif
+}
+
+template<class T>
+const char* CorpusView<T>::open(const char* path) {
+#ifdef FMT_CORPUS_MMAP
+	const int fd = ::open(path, O_RDONLY);
+	if (fd < 0) return "cannot open file";
+	struct stat status;
+	const bool known_size = ::fstat(fd, &status) == 0;
+	if (known_size && uint64_t(status.st_size) >= sizeof(CorpusHeader)) {
+		void* mapping = ::mmap(nullptr, std::size_t(status.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+		if (mapping != MAP_FAILED) {
+			bytes = static_cast<const unsigned char*>(mapping);
+			file_size = uint64_t(status.st_size);
+			is_mapped = true;
+		}
+	}
+	::close(fd);
+#endif
+	if (!is_mapped) {
+		std::FILE* file = std::fopen(path, "rb");
+		if (!file) return "cannot open file";
+		unsigned char block[1 << 16];
+		for (std::size_t got; (got = std::fread(block, 1, sizeof(block), file)) > 0;)
+			buffer.insert(buffer.end(), block, block + got);
+		std::fclose(file);
+		bytes = buffer.data();
+		file_size = buffer.size();
+	}
+
+	if (file_size < sizeof(CorpusHeader)) return "file is too short to be a corpus";
+	std::memcpy(&header, bytes, sizeof(CorpusHeader));
+	if (header.magic != CorpusHeader::MAGIC) return "not a corpus, or of another byte order";
+	if (header.version != CorpusHeader::VERSION) return "unsupported corpus version";
+	if (header.type != _::CorpusTypeOf<T>::value) return "corpus holds values of another type";
+	if (header.arity == 0) return "corpus has no values per item";
+	if (header.table % alignof(uint64_t) != 0 || header.values % alignof(T) != 0 ||
+			header.table > file_size || (file_size - header.table) / sizeof(uint64_t) <= header.count ||
+			header.values > file_size ||
+			(file_size - header.values) / sizeof(T) / header.arity < header.items)
+		return "corpus is truncated";
+	table = reinterpret_cast<const uint64_t*>(bytes + header.table);
+	values = reinterpret_cast<const T*>(bytes + header.values);
+	if (table[0] != 0 || table[header.count] != header.items) return "corpus is corrupt";
+	// Records are read without further checks, so every one must lie within the values
+	for (uint64_t i = 0; i < header.count; ++i)
+		if (table[i] > table[i + 1]) return "corpus is corrupt";
+	return nullptr;
+}
+
+template<class T>
+void CorpusView<T>::close() {
+#ifdef FMT_CORPUS_MMAP
+	if (is_mapped) ::munmap(const_cast<unsigned char*>(bytes), file_size);
+#endif
+	is_mapped = false;
+	bytes = nullptr;
+	table = nullptr;
+	values = nullptr;
+	buffer = std::vector<unsigned char>();
+}
+
+template<class T>
+CorpusWriter<T>::CorpusWriter(const char* path, const unsigned arity, const uint64_t count) {
+	header.magic = CorpusHeader::MAGIC;
+	header.version = CorpusHeader::VERSION;
+	header.type = _::CorpusTypeOf<T>::value;
+	header.arity = arity;
+	header.count = count;
+	header.items = 0;
+	header.table = _::align_position(sizeof(CorpusHeader));
+	header.values = _::align_position(header.table + (count + 1) * sizeof(uint64_t));
+
+	file = std::fopen(path, "wb");
+#ifndef FMT_NOEXCEPT
+	if (!file) throw std::runtime_error(std::string(path) + ": cannot create file");
+#else
+	if (!file) return;
+#endif
+	// Leave the header and the table to be filled in, and start streaming the values
+	if (!_::seek_file(file, header.values)) {
+		std::fclose(file);
+		file = nullptr;
+#ifndef FMT_NOEXCEPT
+		throw std::runtime_error(std::string(path) + ": corpus is too large for this platform");
+#endif
+	}
+	pending.reserve(1 << 12);
+	pending.push_back(0);
+}
+
+template<class T>
+CorpusWriter<T>::~CorpusWriter() {
+	if (file) std::fclose(file);
+}
+
+template<class T>
+void CorpusWriter<T>::flush_table() {
+	if (pending.empty()) return;
+	// The values written so far end where the next record goes
+	const uint64_t position = header.values + header.items * header.arity * sizeof(T);
+	failed |= !_::seek_file(file, header.table + pending_first * sizeof(uint64_t));
+	std::fwrite(pending.data(), sizeof(uint64_t), pending.size(), file);
+	failed |= !_::seek_file(file, position);
+	pending_first += pending.size();
+	pending.clear();
+}
+
+template<class T>
+void CorpusWriter<T>::push(const T* values, const uint64_t length) {
+	if (!file) return;
+#ifndef FMT_NOEXCEPT
+	if (pushed == header.count) throw std::runtime_error("More records pushed than announced.");
+#endif
+	const std::size_t written = std::fwrite(values, sizeof(T), length * header.arity, file);
+#ifndef FMT_NOEXCEPT
+	if (written != length * header.arity) throw std::runtime_error("Cannot write corpus.");
+#else
+	(void) written;
+#endif
+	header.items += length;
+	++pushed;
+	pending.push_back(header.items);
+	if (pending.size() == pending.capacity()) flush_table();
+}
+
+template<class T>
+void CorpusWriter<T>::close() {
+	if (!file) return;
+#ifndef FMT_NOEXCEPT
+	if (pushed != header.count) throw std::runtime_error("Fewer records pushed than announced.");
+#endif
+	flush_table();
+	// Zero the padding behind the table
+	failed |= !_::seek_file(file, header.table + (header.count + 1) * sizeof(uint64_t));
+	const char zeros[64] = {};
+	std::fwrite(zeros, 1, header.values - header.table - (header.count + 1) * sizeof(uint64_t), file);
+	failed |= !_::seek_file(file, 0);
+	std::fwrite(&header, sizeof(CorpusHeader), 1, file);
+	failed |= std::ferror(file) != 0;
+	const bool unclosed = std::fclose(file) != 0;
+	file = nullptr;
+#ifndef FMT_NOEXCEPT
+	if (failed || unclosed) throw std::runtime_error("Cannot write corpus.");
+#else
+	(void) unclosed;
+#endif
+}
+
+} // namespace fmt
+
+#endif
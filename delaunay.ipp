@@ -0,0 +1,102 @@
+#ifndef FMT_DELAUNAY_IPP
+#define FMT_DELAUNAY_IPP
+
+// Flips the interior edges of a triangulation towards the constrained Delaunay triangulation
+
+#include "partition.hpp"
+#include "polygon.hpp"
+#include "predicates.hpp"
+#include "workspace.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace fmt {
+
+template<class T_vert, class T_ind>
+T_ind Polygon<T_vert, T_ind>::flip_delaunay(const T_ind budget) {
+	if (has_valid_indices && has_valid_flips && flip_queue.empty()) return T_ind(0);
+	Workspace<T_vert, T_ind> ws;
+	return flip_delaunay(ws, budget);
+}
+
+template<class T_vert, class T_ind>
+T_ind Polygon<T_vert, T_ind>::flip_delaunay(Workspace<T_vert, T_ind>& ws, const T_ind budget) {
+	const T_ind null = _::null_index<T_ind>();
+	get_indices(ws);
+
+	// Queue every interior edge once, by the half-edge of its first triangle
+	if (!has_valid_flips) {
+		find_twins(twins, ws);
+		queued.assign(twins.size(), uint8_t(0));
+		flip_queue.clear();
+		for (T_ind e = T_ind(0); e < twins.size(); ++e)
+			if (twins[e] != null && e < twins[e]) {
+				flip_queue.push_back(e);
+				queued[e] = uint8_t(1);
+			}
+		has_valid_flips = true;
+	}
+
+	auto next = [](const T_ind e) { return e % 3 == 2 ? e - 2 : e + 1; };
+	auto prev = [](const T_ind e) { return e % 3 == 0 ? e + 2 : e - 1; };
+	auto link = [this, null](const T_ind e, const T_ind twin) {
+		twins[e] = twin;
+		if (twin != null) twins[twin] = e;
+	};
+
+	T_ind flips = T_ind(0);
+	while (!flip_queue.empty() && flips < budget) {
+		const T_ind e0 = flip_queue.back();
+		flip_queue.pop_back();
+		if (!queued[e0]) continue; // moved by an earlier flip and queued again where it went
+		queued[e0] = uint8_t(0);
+
+		// Triangles a, b, c and b, a, d in clockwise orientation share the edge from a to b
+		const T_ind f0 = twins[e0];
+		if (f0 == null) continue;
+		const T_ind e1 = next(e0), e2 = prev(e0), f1 = next(f0), f2 = prev(f0);
+		const T_ind a = indices[e0], b = indices[e1], c = indices[e2], d = indices[f2];
+
+		// The edge is illegal if d lies inside the circle through a, b and c. Quadrilaterals which are
+		// not strictly convex cannot be flipped.
+		if (_::incircle(x(a), y(a), x(c), y(c), x(b), y(b), x(d), y(d)) <= 0) continue;
+		if (_::orientation(x(c), y(c), x(d), y(d), x(a), y(a)) <= 0 ||
+				_::orientation(x(d), y(d), x(c), y(c), x(b), y(b)) <= 0)
+			continue;
+
+		// Replace them by c, a, d and d, b, c, keeping the edges from c to a and from b to c at the
+		// first half-edges of their triangles
+		const T_ind twin_bc = twins[e1], twin_ca = twins[e2], twin_ad = twins[f1], twin_db = twins[f2];
+		indices[e0] = c;
+		indices[e1] = a;
+		indices[e2] = d;
+		indices[f0] = d;
+		indices[f1] = b;
+		indices[f2] = c;
+		link(e0, twin_ca);
+		link(e1, twin_ad);
+		link(e2, f2);
+		link(f0, twin_db);
+		link(f1, twin_bc);
+		++flips;
+
+		// The edges of the quadrilateral may have become illegal
+		queued[e1] = queued[e2] = queued[f0] = queued[f1] = queued[f2] = uint8_t(0);
+		const T_ind sides[4] = {e0, e1, f0, f1};
+		for (unsigned i = 0; i < 4; ++i) {
+			const T_ind side = sides[i], twin = twins[side];
+			if (twin == null || queued[twin]) continue;
+			flip_queue.push_back(side);
+			queued[side] = uint8_t(1);
+		}
+	}
+
+	// The triangles no longer follow the monotone parts
+	if (flips) has_valid_part_map = false;
+	return flips;
+}
+
+} // namespace fmt
+
+#endif
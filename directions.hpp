@@ -0,0 +1,212 @@
+#ifndef FMT_DIRECTIONS_H
+#define FMT_DIRECTIONS_H
+
+/* Defines the vectorised pass finding the x-direction of every edge for Stage 1 of the partition */
+
+#include <cstddef>
+#include <cstdint>
+
+#if !defined(FMT_NO_SIMD) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#	define FMT_X86_SIMD
+#	include <immintrin.h>
+#endif
+
+namespace fmt {
+namespace _ {
+
+//! Whether the edge from vertex 0 to vertex 1 runs in sweep order, see _::is_before. The vertices
+//! are taken to be consecutive in index order.
+template<class T_vert>
+inline bool is_forward(const T_vert x0, const T_vert y0, const T_vert x1, const T_vert y1) {
+	return !(x1 < x0 || (x1 == x0 && y1 < y0));
+}
+
+//! Get the index of the lowest bit set in a non-zero word
+inline unsigned lowest_bit(uint64_t word) {
+#ifdef __GNUC__
+	return unsigned(__builtin_ctzll(word));
+#else
+	unsigned bit = 0;
+	for (; !(word & 1); word >>= 1)
+		++bit;
+	return bit;
+#endif
+}
+
+/* Vectorised kernels. Each one compares the coordinates of vertex i with those of vertex i + 1 for
+	a whole register of edges at once and stores the inverted sign masks as direction bits. The
+	number of lanes divides 64, so that no register straddles two words. They return the number of
+	edges done, the remaining ones are left to the scalar loop.
+*/
+#ifdef FMT_X86_SIMD
+__attribute__((target("avx"))) inline std::size_t edge_directions_avx(const float* xs,
+																																			 const float* ys,
+																																			 const std::size_t count,
+																																			 uint64_t* bits) {
+	std::size_t i = 0;
+	for (; i + 8 < count; i += 8) {
+		const __m256 x0 = _mm256_loadu_ps(xs + i), x1 = _mm256_loadu_ps(xs + i + 1);
+		const __m256 y0 = _mm256_loadu_ps(ys + i), y1 = _mm256_loadu_ps(ys + i + 1);
+		const __m256 back = _mm256_or_ps(
+				_mm256_cmp_ps(x1, x0, _CMP_LT_OQ),
+				_mm256_and_ps(_mm256_cmp_ps(x1, x0, _CMP_EQ_OQ), _mm256_cmp_ps(y1, y0, _CMP_LT_OQ)));
+		bits[i / 64] |= uint64_t(~_mm256_movemask_ps(back) & 0xff) << (i % 64);
+	}
+	return i;
+}
+
+__attribute__((target("avx"))) inline std::size_t edge_directions_avx(const double* xs,
+																																			 const double* ys,
+																																			 const std::size_t count,
+																																			 uint64_t* bits) {
+	std::size_t i = 0;
+	for (; i + 4 < count; i += 4) {
+		const __m256d x0 = _mm256_loadu_pd(xs + i), x1 = _mm256_loadu_pd(xs + i + 1);
+		const __m256d y0 = _mm256_loadu_pd(ys + i), y1 = _mm256_loadu_pd(ys + i + 1);
+		const __m256d back = _mm256_or_pd(
+				_mm256_cmp_pd(x1, x0, _CMP_LT_OQ),
+				_mm256_and_pd(_mm256_cmp_pd(x1, x0, _CMP_EQ_OQ), _mm256_cmp_pd(y1, y0, _CMP_LT_OQ)));
+		bits[i / 64] |= uint64_t(~_mm256_movemask_pd(back) & 0xf) << (i % 64);
+	}
+	return i;
+}
+
+__attribute__((target("avx2"))) inline std::size_t edge_directions_avx2(const int32_t* xs,
+																																				 const int32_t* ys,
+																																				 const std::size_t count,
+																																				 uint64_t* bits) {
+	std::size_t i = 0;
+	for (; i + 8 < count; i += 8) {
+		const __m256i x0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(xs + i));
+		const __m256i x1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(xs + i + 1));
+		const __m256i y0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ys + i));
+		const __m256i y1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ys + i + 1));
+		const __m256i back = _mm256_or_si256(
+				_mm256_cmpgt_epi32(x0, x1),
+				_mm256_and_si256(_mm256_cmpeq_epi32(x1, x0), _mm256_cmpgt_epi32(y0, y1)));
+		bits[i / 64] |= uint64_t(~_mm256_movemask_ps(_mm256_castsi256_ps(back)) & 0xff) << (i % 64);
+	}
+	return i;
+}
+
+#	ifdef __SSE2__
+inline std::size_t edge_directions_sse(const float* xs, const float* ys, const std::size_t count,
+																			 uint64_t* bits) {
+	std::size_t i = 0;
+	for (; i + 4 < count; i += 4) {
+		const __m128 x0 = _mm_loadu_ps(xs + i), x1 = _mm_loadu_ps(xs + i + 1);
+		const __m128 y0 = _mm_loadu_ps(ys + i), y1 = _mm_loadu_ps(ys + i + 1);
+		const __m128 back =
+				_mm_or_ps(_mm_cmplt_ps(x1, x0), _mm_and_ps(_mm_cmpeq_ps(x1, x0), _mm_cmplt_ps(y1, y0)));
+		bits[i / 64] |= uint64_t(~_mm_movemask_ps(back) & 0xf) << (i % 64);
+	}
+	return i;
+}
+
+inline std::size_t edge_directions_sse(const double* xs, const double* ys, const std::size_t count,
+																			 uint64_t* bits) {
+	std::size_t i = 0;
+	for (; i + 2 < count; i += 2) {
+		const __m128d x0 = _mm_loadu_pd(xs + i), x1 = _mm_loadu_pd(xs + i + 1);
+		const __m128d y0 = _mm_loadu_pd(ys + i), y1 = _mm_loadu_pd(ys + i + 1);
+		const __m128d back =
+				_mm_or_pd(_mm_cmplt_pd(x1, x0), _mm_and_pd(_mm_cmpeq_pd(x1, x0), _mm_cmplt_pd(y1, y0)));
+		bits[i / 64] |= uint64_t(~_mm_movemask_pd(back) & 0x3) << (i % 64);
+	}
+	return i;
+}
+
+inline std::size_t edge_directions_sse(const int32_t* xs, const int32_t* ys,
+																			 const std::size_t count, uint64_t* bits) {
+	std::size_t i = 0;
+	for (; i + 4 < count; i += 4) {
+		const __m128i x0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(xs + i));
+		const __m128i x1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(xs + i + 1));
+		const __m128i y0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ys + i));
+		const __m128i y1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ys + i + 1));
+		const __m128i back = _mm_or_si128(
+				_mm_cmpgt_epi32(x0, x1), _mm_and_si128(_mm_cmpeq_epi32(x1, x0), _mm_cmpgt_epi32(y0, y1)));
+		bits[i / 64] |= uint64_t(~_mm_movemask_ps(_mm_castsi128_ps(back)) & 0xf) << (i % 64);
+	}
+	return i;
+}
+#	endif
+
+//! Whether the processor supports AVX, checked once
+inline bool has_avx() {
+	static const bool avx = __builtin_cpu_supports("avx");
+	return avx;
+}
+
+//! Whether the processor supports AVX2, checked once
+inline bool has_avx2() {
+	static const bool avx2 = __builtin_cpu_supports("avx2");
+	return avx2;
+}
+#endif
+
+//! Other coordinate types are left to the scalar loop
+template<class T_vert>
+inline std::size_t edge_directions_simd(const T_vert*, const T_vert*, const std::size_t, uint64_t*) {
+	return 0;
+}
+
+#ifdef FMT_X86_SIMD
+//! Run the widest kernel the processor supports on contiguous float coordinates
+inline std::size_t edge_directions_simd(const float* xs, const float* ys, const std::size_t count,
+																				uint64_t* bits) {
+	if (has_avx()) return edge_directions_avx(xs, ys, count, bits);
+#	ifdef __SSE2__
+	return edge_directions_sse(xs, ys, count, bits);
+#	else
+	return 0;
+#	endif
+}
+
+//! Run the widest kernel the processor supports on contiguous double coordinates
+inline std::size_t edge_directions_simd(const double* xs, const double* ys,
+																				const std::size_t count, uint64_t* bits) {
+	if (has_avx()) return edge_directions_avx(xs, ys, count, bits);
+#	ifdef __SSE2__
+	return edge_directions_sse(xs, ys, count, bits);
+#	else
+	return 0;
+#	endif
+}
+
+//! Run the widest kernel the processor supports on contiguous int32 coordinates
+inline std::size_t edge_directions_simd(const int32_t* xs, const int32_t* ys,
+																				const std::size_t count, uint64_t* bits) {
+	if (has_avx2()) return edge_directions_avx2(xs, ys, count, bits);
+#	ifdef __SSE2__
+	return edge_directions_sse(xs, ys, count, bits);
+#	else
+	return 0;
+#	endif
+}
+#endif
+
+/*! Find the direction of every edge in index order.
+
+	Sets bit i % 64 of bits[i / 64] if the edge from vertex i to vertex i + 1 runs in sweep order,
+	for all i < count - 1. bits must hold count / 64 + 1 words, all zero. Contiguous float, double
+	and int32 coordinates are compared 4 to 8 edges at a time with AVX, AVX2 or SSE2, chosen at
+	runtime; strided coordinates and other types fall back to a scalar loop. Takes Θ(n) either way, but
+	without a branch per vertex.
+
+	@param count Number of vertices, at least 1.
+*/
+template<class T_vert, class T_ind>
+inline void edge_directions(const T_vert* xs, const T_vert* ys, const T_ind stride,
+														const T_ind count, uint64_t* bits) {
+	T_ind i = T_ind(0);
+	if (stride == T_ind(1)) i = T_ind(edge_directions_simd(xs, ys, count, bits));
+
+	for (; i + 1 < count; ++i) {
+		const T_vert x0 = xs[i * stride], x1 = xs[(i + 1) * stride];
+		bits[i / 64] |= uint64_t(is_forward(x0, ys[i * stride], x1, ys[(i + 1) * stride])) << (i % 64);
+	}
+}
+} // namespace _
+} // namespace fmt
+#endif
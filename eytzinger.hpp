@@ -0,0 +1,44 @@
+#ifndef FMT_EYTZINGER_H
+#define FMT_EYTZINGER_H
+
+/* Defines a flat search tree over sorted keys in Eytzinger (breadth-first) layout */
+
+#include <vector>
+
+namespace fmt {
+namespace _ {
+
+/*! A static search tree stored as a flat array in Eytzinger layout. Not meant for external use.
+
+	Takes a *sorted* vector as input. Node k of the implicit tree is stored at index k, its children
+	at 2k and 2k + 1, so that the top levels of the tree share few cache lines and no pointers are
+	stored. This implementation is specific to the triangulation algorithm in that it deduces the
+	key from accessing the member variable "x" from the provided data.
+
+	Keys and data are kept in separate arrays owned by the caller, which are overwritten on
+	construction.
+
+	@tparam T_key Type of the keys, == T_vert.
+	@tparam T_data Type of the data object, must be a pointer.
+	@tparam T_ind Integer type to use for indexing
+*/
+template<class T_key, class T_data, class T_ind>
+class Eytzinger {
+private:
+	std::vector<T_key>& keys;  //!< Keys in Eytzinger order. keys[0] is unused.
+	std::vector<T_data>& data; //!< Data in Eytzinger order. data[0] holds the largest element.
+	const T_ind count;         //!< Number of elements
+
+	// Fill the tree in order, recursing at most log2(count) deep
+	T_ind _construct(const std::vector<T_data>& vec, T_ind i, const T_ind k);
+
+public:
+	Eytzinger(const std::vector<T_data>& vec, std::vector<T_key>& keys, std::vector<T_data>& data);
+
+	//! Finds the first element whose key is greater than or equal to key without branching on the
+	//! comparisons. Returns the largest element if there is none.
+	T_data find(const T_key key) const;
+};
+} // namespace _
+} // namespace fmt
+#endif
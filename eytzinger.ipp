@@ -0,0 +1,50 @@
+#ifndef FMT_EYTZINGER_IPP
+#define FMT_EYTZINGER_IPP
+
+#include "eytzinger.hpp"
+
+template<class T_key, class T_data, class T_ind>
+fmt::_::Eytzinger<T_key, T_data, T_ind>::Eytzinger(const std::vector<T_data>& vec,
+																									std::vector<T_key>& keys,
+																									std::vector<T_data>& data)
+		: keys(keys), data(data), count(vec.size()) {
+	keys.resize(count + 1);
+	data.resize(count + 1);
+
+	// a search which is greater than every key ends at index 0
+	data[0] = vec.back();
+	_construct(vec, T_ind(0), T_ind(1));
+}
+
+template<class T_key, class T_data, class T_ind>
+T_ind fmt::_::Eytzinger<T_key, T_data, T_ind>::_construct(const std::vector<T_data>& vec, T_ind i,
+																												 const T_ind k) {
+	if (k > count) return i;
+
+	i = _construct(vec, i, T_ind(2) * k);
+	keys[k] = vec[i]->x;
+	data[k] = vec[i];
+	return _construct(vec, i + 1, T_ind(2) * k + 1);
+}
+
+template<class T_key, class T_data, class T_ind>
+T_data fmt::_::Eytzinger<T_key, T_data, T_ind>::find(const T_key key) const {
+	// Descend right while the key is smaller than the search key. The comparison compiles to a
+	// conditional add rather than a branch.
+	T_ind k = T_ind(1);
+	while (k <= count)
+		k = T_ind(2) * k + T_ind(keys[k] < key);
+
+	// The result is the last node at which the search went left. Strip the right turns taken after
+	// it, then the left turn itself.
+#if defined(__GNUC__) || defined(__clang__)
+	k >>= __builtin_ctzll(~static_cast<unsigned long long>(k)) + 1;
+#else
+	while (k & T_ind(1))
+		k >>= 1;
+	k >>= 1;
+#endif
+
+	return data[k];
+}
+#endif
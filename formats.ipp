@@ -0,0 +1,203 @@
+#ifndef FMT_FORMATS_IPP
+#define FMT_FORMATS_IPP
+
+// Writes triangulations as narrow index lists, triangle strips and triangle adjacency
+
+#include "output.hpp"
+#include "partition.hpp"
+#include "polygon.hpp"
+#include "workspace.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#ifndef FMT_NOEXCEPT
+#	include <stdexcept>
+#endif
+
+namespace fmt {
+
+template<class T_vert, class T_ind>
+template<class T_out>
+void Polygon<T_vert, T_ind>::get_indices(std::vector<T_out>& out) {
+	Workspace<T_vert, T_ind> ws;
+	get_indices(out, ws);
+}
+
+template<class T_vert, class T_ind>
+template<class T_out>
+void Polygon<T_vert, T_ind>::get_indices(std::vector<T_out>& out, Workspace<T_vert, T_ind>& ws) {
+#ifndef FMT_NOEXCEPT
+	if (n_verts - T_ind(1) > T_ind(std::numeric_limits<T_out>::max()))
+		throw std::invalid_argument("Polygon has too many vertices for the index type.");
+#endif
+	out.clear();
+	out.reserve(3 * triangle_count());
+	stream_indices(
+			[&out](const T_ind* indices, const T_ind count) {
+				for (T_ind i = T_ind(0); i < count; ++i)
+					out.push_back(T_out(indices[i]));
+			},
+			ws);
+}
+
+template<class T_vert, class T_ind>
+template<class T_out>
+void Polygon<T_vert, T_ind>::get_strips(std::vector<T_out>& strips) {
+	Workspace<T_vert, T_ind> ws;
+	get_strips(strips, ws);
+}
+
+template<class T_vert, class T_ind>
+template<class T_out>
+void Polygon<T_vert, T_ind>::get_strips(std::vector<T_out>& strips, Workspace<T_vert, T_ind>& ws) {
+#ifndef FMT_NOEXCEPT
+	// the largest value is the restart index
+	if (n_verts > T_ind(std::numeric_limits<T_out>::max()))
+		throw std::invalid_argument("Polygon has too many vertices for the index type.");
+#endif
+	const T_ind null = _::null_index<T_ind>();
+	const std::vector<T_ind>& tris = get_indices(ws);
+	std::vector<T_ind>& twins = ws.strip_twins;
+	find_twins(twins, ws);
+	const T_ind n_tris = tris.size() / 3;
+
+	auto next = [](const T_ind e) { return e % 3 == 2 ? e - 2 : e + 1; };
+	auto prev = [](const T_ind e) { return e % 3 == 0 ? e + 2 : e - 1; };
+
+	// Start the strips at the triangles with the fewest neighbours, so that they run from the ears
+	// of the triangulation inwards rather than cutting it into pieces
+	auto neighbours = [&twins, null](const T_ind t) {
+		return unsigned(twins[3 * t] != null) + (twins[3 * t + 1] != null) + (twins[3 * t + 2] != null);
+	};
+	std::vector<T_ind>& order = ws.strip_order;
+	T_ind firsts[5] = {T_ind(0)};
+	for (T_ind t = T_ind(0); t < n_tris; ++t)
+		++firsts[neighbours(t) + 1];
+	for (unsigned d = 1; d < 4; ++d)
+		firsts[d + 1] += firsts[d];
+	order.resize(n_tris);
+	for (T_ind t = T_ind(0); t < n_tris; ++t)
+		order[firsts[neighbours(t)]++] = t;
+
+	std::vector<uint8_t>& done = ws.strip_done;
+	done.assign(n_tris, uint8_t(0));
+	auto is_free = [&twins, &done, null](const T_ind e) {
+		return twins[e] != null && !done[twins[e] / 3];
+	};
+	auto append = [&strips](const T_ind v) { strips.push_back(T_out(v)); };
+
+	strips.clear();
+	strips.reserve(tris.size() / 2);
+	for (auto&& it = order.cbegin(); it != order.cend(); ++it) {
+		if (done[*it]) continue;
+		done[*it] = uint8_t(1);
+		if (!strips.empty()) strips.push_back(std::numeric_limits<T_out>::max());
+
+		// Leave the first triangle towards the neighbour with the fewest neighbours left
+		T_ind out = null;
+		unsigned fewest = 4;
+		for (T_ind e = 3 * *it; e < 3 * *it + 3; ++e) {
+			if (!is_free(e)) continue;
+			const T_ind f = twins[e];
+			const unsigned left = is_free(f - f % 3) + is_free(f - f % 3 + 1) + is_free(f - f % 3 + 2);
+			if (left < fewest) {
+				out = e;
+				fewest = left;
+			}
+		}
+		if (out == null) out = 3 * *it;
+		append(tris[prev(out)]);
+		append(tris[out]);
+		append(tris[next(out)]);
+		if (!is_free(out)) continue;
+
+		/*
+			The strip ends in u and w, and each triangle across the edge between them adds its third
+			vertex r. Continuing across the edge from w to r takes no more, continuing across the one
+			from u to r repeats u first as a degenerate triangle. A strip ends where neither is free.
+		*/
+		T_ind u = tris[out], w = tris[next(out)];
+		for (T_ind e = twins[out];;) {
+			done[e / 3] = uint8_t(1);
+			const T_ind r = tris[prev(e)];
+			const T_ind to_w = tris[next(e)] == w ? next(e) : prev(e),
+									to_u = tris[next(e)] == w ? prev(e) : next(e);
+			if (is_free(to_w)) {
+				append(r);
+				u = w;
+				w = r;
+				e = twins[to_w];
+			} else if (is_free(to_u)) {
+				append(u);
+				append(r);
+				w = r;
+				e = twins[to_u];
+			} else {
+				append(r);
+				break;
+			}
+		}
+	}
+}
+
+template<class T_vert, class T_ind>
+void Polygon<T_vert, T_ind>::get_adjacency(std::vector<T_ind>& adjacency) {
+	Workspace<T_vert, T_ind> ws;
+	get_adjacency(adjacency, ws);
+}
+
+template<class T_vert, class T_ind>
+void Polygon<T_vert, T_ind>::get_adjacency(std::vector<T_ind>& adjacency,
+																					 Workspace<T_vert, T_ind>& ws) {
+	get_indices(ws);
+	find_twins(adjacency, ws);
+	for (auto&& it = adjacency.begin(); it != adjacency.end(); ++it)
+		if (*it != _::null_index<T_ind>()) *it /= T_ind(3);
+}
+
+template<class T_vert, class T_ind>
+void Polygon<T_vert, T_ind>::find_twins(std::vector<T_ind>& twins,
+																				Workspace<T_vert, T_ind>& ws) const {
+	const std::vector<T_ind>& tris = indices;
+	const T_ind n_edges = tris.size();
+
+	// Edge e of triangle e / 3 runs from tris[e] to tris[e + 1], wrapping around within the triangle
+	auto other = [&tris](const T_ind e) { return tris[e % 3 == 2 ? e - 2 : e + 1]; };
+	auto low = [&tris, &other](const T_ind e) { return std::min(tris[e], other(e)); };
+	auto high = [&tris, &other](const T_ind e) { return std::max(tris[e], other(e)); };
+
+	// Bucket the edges by their lower vertex. Both edges along a diagonal or a triangle side share
+	// a bucket and lie next to each other once it is sorted by the higher vertex.
+	std::vector<T_ind>& offsets = ws.edge_offsets;
+	std::vector<T_ind>& edges = ws.edges;
+	offsets.assign(n_verts + 1, T_ind(0));
+	edges.resize(n_edges);
+	for (T_ind e = T_ind(0); e < n_edges; ++e)
+		++offsets[low(e) + 1];
+	for (T_ind v = T_ind(0); v < n_verts; ++v)
+		offsets[v + 1] += offsets[v];
+	for (T_ind e = T_ind(0); e < n_edges; ++e)
+		edges[offsets[low(e)]++] = e;
+	// offsets[v] now holds the end of bucket v, which is where bucket v + 1 starts
+	for (T_ind v = n_verts; v > T_ind(0); --v)
+		offsets[v] = offsets[v - 1];
+	offsets[0] = T_ind(0);
+
+	twins.assign(n_edges, _::null_index<T_ind>());
+	for (T_ind v = T_ind(0); v < n_verts; ++v) {
+		const auto begin = edges.begin() + offsets[v], end = edges.begin() + offsets[v + 1];
+		std::sort(begin, end, [&high](const T_ind a, const T_ind b) { return high(a) < high(b); });
+		for (auto it = begin; it + 1 < end; ++it) {
+			if (high(*it) != high(*(it + 1))) continue;
+			twins[*it] = *(it + 1);
+			twins[*(it + 1)] = *it;
+			++it;
+		}
+	}
+}
+
+} // namespace fmt
+
+#endif
@@ -0,0 +1,109 @@
+#ifndef FMT_INCREMENTAL_IPP
+#define FMT_INCREMENTAL_IPP
+
+// Keeps monotone parts between triangulations and re-triangulates only the parts touched by edits
+
+#include "partition.hpp"
+#include "polygon.hpp"
+#include "workspace.hpp"
+
+#include <algorithm>
+#include <vector>
+
+namespace fmt {
+
+template<class T_vert, class T_ind>
+void Polygon<T_vert, T_ind>::map_parts() {
+	const T_ind null = _::null_index<T_ind>();
+
+	has_valid_part_map = false;
+	part_offsets.clear();
+	part_offsets.push_back(T_ind(0));
+	vertex_parts.assign(n_verts, null);
+	edits.clear();
+
+	// Walk both chains of every part. Vertices whose links are not their neighbours on the polygon
+	// are endpoints of diagonals, as are split vertices found in more than one part; they bound
+	// more than one part, keep null and cannot be edited incrementally.
+	const T_ind shared = null - T_ind(1);
+	auto locate = [this, null, shared](const T_ind vert, const T_ind part) {
+		if (nexts[vert] != ring_next(vert) || prevs[vert] != ring_prev(vert)) return;
+		vertex_parts[vert] = vertex_parts[vert] == null || vertex_parts[vert] == part ? part : shared;
+	};
+
+	for (auto&& it = parts.cbegin(); it != parts.cend(); ++it) {
+		const T_ind part = it - parts.cbegin();
+		part_offsets.push_back(part_offsets.back() + T_ind(3) * part_triangle_count(*it));
+
+		locate(it->head, part);
+		locate(it->tail, part);
+		for (T_ind i = it->first_upper; i != it->tail; i = nexts[i])
+			locate(i, part);
+		for (T_ind i = it->first_lower; i != it->tail; i = prevs[i])
+			locate(i, part);
+	}
+	for (auto&& it = vertex_parts.begin(); it != vertex_parts.end(); ++it)
+		if (*it == shared) *it = null;
+
+	has_valid_part_map = part_offsets.back() == indices.size();
+}
+
+template<class T_vert, class T_ind>
+bool Polygon<T_vert, T_ind>::update_parts(Workspace<T_vert, T_ind>& ws) {
+	// Replace every edit by the part it lies in and visit each part once
+	for (auto&& it = edits.begin(); it != edits.end(); ++it) {
+		*it = vertex_parts[*it];
+		if (*it == _::null_index<T_ind>()) return false;
+	}
+	std::sort(edits.begin(), edits.end());
+	edits.erase(std::unique(edits.begin(), edits.end()), edits.end());
+
+	for (auto&& it = edits.cbegin(); it != edits.cend(); ++it)
+		if (!is_monotone(parts[*it])) return false;
+
+	// Each part has room for the vertices appended to it, so it is written back to its own range
+	if (ws.chain.size() < n_verts) ws.chain.resize(n_verts);
+	for (auto&& it = edits.cbegin(); it != edits.cend(); ++it) {
+		_::BufferOutput<T_ind> part_out{indices.data() + part_offsets[*it],
+																		indices.data() + part_offsets[*it + 1]};
+		triangulate_part(parts[*it], part_out, ws.chain.data());
+		// A part which misses some of its vertices leaves its range partly unwritten
+		if (part_out.out != part_out.end) return false;
+	}
+
+	edits.clear();
+	has_valid_indices = true;
+	has_valid_flips = false;
+	return true;
+}
+
+template<class T_vert, class T_ind>
+bool Polygon<T_vert, T_ind>::is_monotone(const MonoPart<T_ind>& part) const {
+	// Merge both chains in sweep order as in triangulate_part. Each chain must be monotone, and every
+	// vertex must lie strictly on its own side of the edge of the opposite chain spanning its x.
+	const T_ind head = part.head, tail = part.tail;
+	T_ind upper = part.first_upper, lower = part.first_lower;
+	T_ind last_upper = head, last_lower = head;
+
+	while (upper != tail || lower != tail) {
+		if (lower == tail || (upper != tail && !before(lower, upper))) {
+			if (before(upper, last_upper)) return false;
+			if (!_::is_reflex(x(last_lower), y(last_lower), x(lower), y(lower), x(upper), y(upper)))
+				return false;
+			last_upper = upper;
+			upper = nexts[upper];
+		} else {
+			if (before(lower, last_lower)) return false;
+			if (!_::is_reflex(x(upper), y(upper), x(last_upper), y(last_upper), x(lower), y(lower)))
+				return false;
+			last_lower = lower;
+			lower = prevs[lower];
+		}
+	}
+
+	return !before(tail, last_upper) && !before(tail, last_lower);
+}
+
+} // namespace fmt
+
+#endif
@@ -0,0 +1,122 @@
+#ifndef FMT_INSTRUMENT_H
+#define FMT_INSTRUMENT_H
+
+/* Defines the opt-in instrumentation of the partition and triangulation: timings of each stage,
+ * counters of the work done by the sweep, and trace callbacks. Define FMT_INSTRUMENT to enable it;
+ * otherwise the hooks compile to nothing and all statistics stay zero.
+ */
+
+#include <cstdint>
+
+#ifdef FMT_INSTRUMENT
+#	include <chrono>
+#endif
+
+namespace fmt {
+//! Stages of the triangulation timed by fmt::Stats
+enum Stage : unsigned {
+	EVENTS,      //!< Stage 1 of the partition: finding the event vertices
+	SORT,        //!< Stage 2 of the partition: sorting the split vertices
+	LOCATE,      //!< Stage 2 of the partition: attaching start vertices to split vertices
+	SWEEP,       //!< Stage 3 of the partition: the sweep, including keeping the parts
+	TRIANGULATE, //!< Triangulating the monotone parts
+	STAGE_COUNT
+};
+
+/*! Statistics gathered by a fmt::Workspace while it is used.
+
+	Only filled if FMT_INSTRUMENT is defined, else all members stay zero. Statistics add up over all
+	calls using the workspace until it is reset through fmt::Workspace::reset_stats.
+*/
+struct Stats {
+	uint64_t nanoseconds[STAGE_COUNT] = {}; //!< Time spent in each stage
+
+	uint64_t starts = 0; //!< Start vertices found
+	uint64_t stops = 0;  //!< Stop vertices found
+	uint64_t splits = 0; //!< Split vertices found
+	uint64_t merges = 0; //!< Merge vertices found
+
+	uint64_t monotone = 0; //!< Partitions which found the polygon x-monotone and skipped the sweep
+
+	uint64_t split_lookups = 0; //!< Start vertices located in the search tree over the splits
+
+	uint64_t tree_inserts = 0; //!< Parts inserted into the interval tree of the sweep
+	uint64_t tree_removes = 0; //!< Parts removed from the interval tree
+	uint64_t tree_finds = 0;   //!< Split vertices located in the interval tree
+	uint64_t tree_depth = 0;   //!< Deepest node reached by an insertion or a search
+
+	//! Vertices passed while walking the chains of the parts up to the sweep, which mostly happens
+	//! when a merge vertex looks for the vertex to connect to
+	uint64_t chain_steps = 0;
+
+	uint64_t grown_stages = 0; //!< Stages in which the workspace had to allocate memory
+	uint64_t grown_bytes = 0;  //!< Bytes added to the capacity of the workspace
+};
+
+/*! Callback invoked by a fmt::Workspace at the end of every stage, if FMT_INSTRUMENT is defined.
+
+	Receives the stage, the time it took, the statistics of the workspace including that stage, and
+	the pointer passed to fmt::Workspace::set_trace. Runs on the thread calling the library, between
+	two stages; it should return quickly.
+*/
+typedef void (*Trace)(Stage stage, uint64_t nanoseconds, const Stats& stats, void* user);
+
+namespace _ {
+//! Add to a counter of fmt::Stats. Does nothing unless FMT_INSTRUMENT is defined.
+inline void count(uint64_t& counter, const uint64_t amount = 1) {
+#ifdef FMT_INSTRUMENT
+	counter += amount;
+#else
+	(void) counter;
+	(void) amount;
+#endif
+}
+
+//! Raise a counter of fmt::Stats to a value. Does nothing unless FMT_INSTRUMENT is defined.
+inline void count_max(uint64_t& counter, const uint64_t value) {
+#ifdef FMT_INSTRUMENT
+	if (counter < value) counter = value;
+#else
+	(void) counter;
+	(void) value;
+#endif
+}
+
+/*! Splits the time of a call into consecutive stages. Not meant for external use.
+
+	Each lap adds the time since the previous lap, or since start, to a stage. Does nothing unless
+	FMT_INSTRUMENT is defined.
+*/
+class StageClock {
+#ifdef FMT_INSTRUMENT
+	typedef std::chrono::steady_clock Clock;
+	Clock::time_point last;
+#endif
+
+public:
+	//! Begin timing the first stage
+	void start() {
+#ifdef FMT_INSTRUMENT
+		last = Clock::now();
+#endif
+	}
+
+	//! Add the time since the previous lap to a stage, and return it
+	uint64_t lap(Stats& stats, const Stage stage) {
+#ifdef FMT_INSTRUMENT
+		const Clock::time_point now = Clock::now();
+		const uint64_t nanoseconds =
+				uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(now - last).count());
+		stats.nanoseconds[stage] += nanoseconds;
+		last = now;
+		return nanoseconds;
+#else
+		(void) stats;
+		(void) stage;
+		return 0;
+#endif
+	}
+};
+} // namespace _
+} // namespace fmt
+#endif
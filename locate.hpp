@@ -0,0 +1,123 @@
+#ifndef FMT_LOCATE_H
+#define FMT_LOCATE_H
+
+/* Defines a point location index over the triangulation of a polygon, answering which triangle
+ * contains a point
+ */
+
+#include "polygon.hpp"
+
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace fmt {
+/*! Finds the triangle of a triangulated polygon containing a point.
+
+	The triangulation found through the monotone partition has no edges crossing each other, so all
+	edges spanning a vertical slab between two successive vertex x coordinates are ordered from
+	bottom to top. The locator keeps a segment tree over these slabs, storing every edge in the
+	Θ(log n) nodes whose slabs it spans, sorted by height. A point is located by walking from the
+	slab containing its x coordinate up to the root, and searching each node for the lowest edge
+	above the point. The triangle below that edge contains the point; if the edge has no triangle
+	below it, or if there is no edge above, the point lies outside of the polygon or in a hole.
+
+	A query takes Θ(log² n) in the worst case, with one binary search per level of the tree, and
+	the index takes Θ(n log n) memory; typical triangulations have short edges, which are stored in
+	few nodes. All tests use the exact predicates of the partition, so that the results are exact
+	for integral coordinates and for floating-point coordinates given exactly.
+
+	Points on an edge are located as if moved up by an infinitesimal amount, and points on a vertex
+	or a vertical edge as if moved right as well. In particular, points on the bottom boundary of
+	the polygon count as inside, points on its top boundary as outside.
+
+	The locator copies all it needs from the polygon, so the polygon may change or go away after
+	building the index.
+
+	@tparam T_vert numeric type of a coordinate component, e.g. float.
+	@tparam T_ind numeric type of an index, e.g. uint_fast32_t.
+*/
+template<class T_vert, class T_ind>
+class Locator {
+private:
+	//! Edge of the triangulation, from its left to its right end point
+	struct Edge {
+		T_vert x0, y0, x1, y1;
+		T_ind below; //!< Triangle below the edge, null_index if the edge bounds the polygon from below
+	};
+
+	//! Index of an edge. At least 32 bits, as a polygon has more edges than vertices.
+	typedef typename std::conditional<(sizeof(T_ind) < sizeof(uint32_t)), uint32_t, T_ind>::type
+			T_edge;
+
+	std::vector<T_vert> slab_xs;    //!< Distinct x coordinates of all vertices in increasing order
+	std::vector<Edge> edges;        //!< All non-vertical edges of the triangulation
+	std::vector<T_edge> offsets;    //!< Offset of the edges of each node of the segment tree
+	std::vector<T_edge> node_edges; //!< Edges of all nodes, each node sorted from bottom to top
+	std::vector<T_ind> adjacency;   //!< Scratch memory kept between builds
+
+	//! Number of slabs, which is the number of leaves of the segment tree
+	T_ind slab_count() const { return T_ind(slab_xs.size() - 1); }
+
+	//! Whether edge a lies below edge b. Both must span a common x interval.
+	bool is_below(const T_edge a, const T_edge b) const;
+
+	//! Whether a point lies strictly below an edge spanning its x coordinate
+	bool is_above(const Edge& edge, const T_vert x, const T_vert y) const {
+		return _::orientation(edge.x0, edge.y0, edge.x1, edge.y1, x, y) < 0;
+	}
+
+public:
+	//! Construct an empty locator, which finds no triangle for any point. See build.
+	Locator() = default;
+
+	//! Construct a locator for the triangulation of a polygon. See build.
+	Locator(Polygon<T_vert, T_ind>& poly) { build(poly); }
+
+	/*! Build the index for the triangulation of a polygon
+
+		Triangulates the polygon through fmt::Polygon::get_indices unless its cached indices are
+		valid, and indexes those triangles. Storage of a previous index is reused. Takes
+		Θ(n log² n).
+
+		@param poly Polygon to index.
+	*/
+	void build(Polygon<T_vert, T_ind>& poly);
+
+	/*! Build the index for the triangulation of a polygon
+
+		Behaves like fmt::Locator::build(Polygon<T_vert, T_ind>&), but triangulates the polygon with
+		the scratch memory of the given workspace.
+
+		@param poly Polygon to index.
+		@param ws Workspace to use.
+	*/
+	void build(Polygon<T_vert, T_ind>& poly, Workspace<T_vert, T_ind>& ws);
+
+	/*! Find the triangle containing a point
+
+		@return Index of the triangle in the indices of the polygon as returned by
+		fmt::Polygon::get_indices, i.e. the triangle made of the indices at 3 times the result.
+		null_index if the point lies outside of the polygon.
+	*/
+	T_ind locate(const T_vert x, const T_vert y) const;
+
+	/*! Find the triangles containing a batch of points
+
+		Locates every point as fmt::Locator::locate(const T_vert, const T_vert) does. The index is
+		only read, so the points are located on the given number of threads without
+		synchronisation.
+
+		@param xy Interleaved x and y coordinates of the points.
+		@param count Number of points.
+		@param out Output array of count triangle indices.
+		@param threads Number of threads to use. 0 uses one thread per hardware thread. Defaults
+		to 1.
+	*/
+	void locate(const T_vert* xy, const T_ind count, T_ind* out, const unsigned threads = 1) const;
+};
+} // namespace fmt
+
+#include "locate.ipp"
+
+#endif
@@ -0,0 +1,154 @@
+#ifndef FMT_LOCATE_IPP
+#define FMT_LOCATE_IPP
+
+// Builds and queries the point location index over the triangulation of a polygon
+
+#include "locate.hpp"
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace fmt {
+
+template<class T_vert, class T_ind>
+void Locator<T_vert, T_ind>::build(Polygon<T_vert, T_ind>& poly) {
+	Workspace<T_vert, T_ind> ws;
+	build(poly, ws);
+}
+
+template<class T_vert, class T_ind>
+void Locator<T_vert, T_ind>::build(Polygon<T_vert, T_ind>& poly, Workspace<T_vert, T_ind>& ws) {
+	// Adjacency marks the edges on the boundary, which have a triangle on one side only
+	poly.get_adjacency(adjacency, ws);
+	const std::vector<T_ind>& tris = poly.get_indices(ws);
+
+	slab_xs.resize(poly.size());
+	for (T_ind i = T_ind(0); i < poly.size(); ++i)
+		slab_xs[i] = poly.x(i);
+	std::sort(slab_xs.begin(), slab_xs.end());
+	slab_xs.erase(std::unique(slab_xs.begin(), slab_xs.end()), slab_xs.end());
+
+	// Keep every edge once, directed from left to right. Vertical edges span no slab.
+	edges.clear();
+	for (std::size_t e = 0; e < tris.size(); ++e) {
+		const T_ind a = tris[e], b = tris[e % 3 == 2 ? e - 2 : e + 1];
+		// Triangles are clockwise, so the triangle of an edge running right lies below it. An edge
+		// running left is kept through its twin, or as the lower boundary if it has none.
+		if (poly.x(a) < poly.x(b))
+			edges.push_back(Edge{poly.x(a), poly.y(a), poly.x(b), poly.y(b), T_ind(e / 3)});
+		else if (poly.x(b) < poly.x(a) && adjacency[e] == _::null_index<T_ind>())
+			edges.push_back(Edge{poly.x(b), poly.y(b), poly.x(a), poly.y(a), _::null_index<T_ind>()});
+	}
+
+	offsets.clear();
+	node_edges.clear();
+	if (slab_xs.size() < 2) return;
+
+	// Bottom-up segment tree: the leaf of slab s is node n + s, node k has children 2k and 2k + 1.
+	// An edge over slabs [l, r) is stored in the nodes covering exactly that range.
+	const std::size_t n = slab_count();
+	auto leaf = [this, n](const T_vert x) {
+		return std::size_t(std::lower_bound(slab_xs.begin(), slab_xs.end(), x) - slab_xs.begin()) + n;
+	};
+
+	// Count the edges of each node, then place them
+	offsets.assign(2 * n + 1, T_edge(0));
+	for (T_edge e = T_edge(0); e < edges.size(); ++e)
+		for (std::size_t l = leaf(edges[e].x0), r = leaf(edges[e].x1); l < r; l >>= 1, r >>= 1) {
+			if (l & 1) ++offsets[1 + l++];
+			if (r & 1) ++offsets[1 + --r];
+		}
+	for (std::size_t k = 0; k < 2 * n; ++k)
+		offsets[k + 1] += offsets[k];
+
+	node_edges.resize(offsets[2 * n]);
+	std::vector<T_edge> cursor(offsets.begin(), offsets.end() - 1);
+	for (T_edge e = T_edge(0); e < edges.size(); ++e)
+		for (std::size_t l = leaf(edges[e].x0), r = leaf(edges[e].x1); l < r; l >>= 1, r >>= 1) {
+			if (l & 1) node_edges[cursor[l++]++] = e;
+			if (r & 1) node_edges[cursor[--r]++] = e;
+		}
+
+	// Sort each node by the height of its edges at an x coordinate they all span, which is cheap but
+	// rounded, then let the exact comparison fix the few edges out of place
+	std::vector<std::pair<double, T_edge>> keyed;
+	for (std::size_t k = 1; k < 2 * n; ++k) {
+		const auto begin = node_edges.begin() + offsets[k], end = node_edges.begin() + offsets[k + 1];
+		if (end - begin < 2) continue;
+		double left = double(edges[*begin].x0), right = double(edges[*begin].x1);
+		for (auto it = begin; it != end; ++it) {
+			left = std::max(left, double(edges[*it].x0));
+			right = std::min(right, double(edges[*it].x1));
+		}
+		const double x = (left + right) / 2;
+		keyed.clear();
+		for (auto it = begin; it != end; ++it) {
+			const Edge& edge = edges[*it];
+			const double t = (x - double(edge.x0)) / (double(edge.x1) - double(edge.x0));
+			keyed.push_back(std::make_pair(double(edge.y0) + t * (double(edge.y1) - double(edge.y0)), *it));
+		}
+		std::sort(keyed.begin(), keyed.end());
+		for (std::size_t i = 0; i < keyed.size(); ++i) {
+			std::size_t j = i;
+			for (; j > 0 && is_below(keyed[i].second, *(begin + (j - 1))); --j)
+				*(begin + j) = *(begin + (j - 1));
+			*(begin + j) = keyed[i].second;
+		}
+	}
+}
+
+template<class T_vert, class T_ind>
+bool Locator<T_vert, T_ind>::is_below(const T_edge a, const T_edge b) const {
+	const Edge &ea = edges[a], &eb = edges[b];
+	// Test the end points of the edge starting further right against the line through the other
+	// one. If the edges share the left end point, the right one decides.
+	if (eb.x0 <= ea.x0) {
+		int side = _::orientation(eb.x0, eb.y0, eb.x1, eb.y1, ea.x0, ea.y0);
+		if (!side) side = _::orientation(eb.x0, eb.y0, eb.x1, eb.y1, ea.x1, ea.y1);
+		if (side) return side < 0;
+	} else {
+		int side = _::orientation(ea.x0, ea.y0, ea.x1, ea.y1, eb.x0, eb.y0);
+		if (!side) side = _::orientation(ea.x0, ea.y0, ea.x1, ea.y1, eb.x1, eb.y1);
+		if (side) return side > 0;
+	}
+	// Overlapping collinear edges only occur in degenerate triangulations
+	return a < b;
+}
+
+template<class T_vert, class T_ind>
+T_ind Locator<T_vert, T_ind>::locate(const T_vert x, const T_vert y) const {
+	// Also rejects NaN
+	if (slab_xs.size() < 2 || !(slab_xs.front() <= x && x < slab_xs.back()))
+		return _::null_index<T_ind>();
+	const std::size_t n = slab_count();
+	const std::size_t slab =
+			std::size_t(std::upper_bound(slab_xs.begin(), slab_xs.end(), x) - slab_xs.begin()) - 1;
+
+	// Every node on the path to the root holds edges spanning x; take the lowest one above the point
+	bool found = false;
+	T_edge lowest = T_edge(0);
+	for (std::size_t k = n + slab; k > 0; k >>= 1) {
+		const auto begin = node_edges.begin() + offsets[k], end = node_edges.begin() + offsets[k + 1];
+		const auto above = std::partition_point(
+				begin, end, [this, x, y](const T_edge e) { return !is_above(edges[e], x, y); });
+		if (above == end) continue;
+		if (!found || is_below(*above, lowest)) lowest = *above;
+		found = true;
+	}
+	return found ? edges[lowest].below : _::null_index<T_ind>();
+}
+
+template<class T_vert, class T_ind>
+void Locator<T_vert, T_ind>::locate(const T_vert* xy, const T_ind count, T_ind* out,
+																		const unsigned threads) const {
+	_::parallel_for(count, T_ind(256), threads, [this, xy, out](const T_ind begin, const T_ind end,
+																															 const unsigned) {
+		for (T_ind i = begin; i < end; ++i)
+			out[i] = locate(xy[2 * i], xy[2 * i + 1]);
+	});
+}
+
+} // namespace fmt
+
+#endif
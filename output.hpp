@@ -0,0 +1,66 @@
+#ifndef FMT_OUTPUT_H
+#define FMT_OUTPUT_H
+
+/* Defines the outputs the triangulation of monotone parts writes its triangles to */
+
+#ifndef FMT_NOEXCEPT
+#	include <stdexcept>
+#endif
+
+namespace fmt {
+namespace _ {
+//! Writes triangles to a caller-owned buffer of fixed size. Not meant for external use.
+template<class T_ind>
+struct BufferOutput {
+	T_ind* out;       //!< Position to write the next triangle to
+	const T_ind* end; //!< End of the buffer
+
+	//! Write a triangle
+	void push(const T_ind a, const T_ind b, const T_ind c) {
+#ifndef FMT_NOEXCEPT
+		if (out == end)
+			throw std::length_error("Triangulation has more than n - 2 triangles. Is the polygon simple?");
+#endif
+		*(out++) = a;
+		*(out++) = b;
+		*(out++) = c;
+	}
+};
+
+/*! Collects triangles in a chunk of fixed size and hands every full chunk to a sink. Not meant for
+	external use.
+
+	The sink is called as sink(indices, count) with a pointer to the indices of the chunk and their
+	number, which is a multiple of 3. See fmt::Polygon::stream_indices.
+*/
+template<class T_ind, class T_sink>
+struct SinkOutput {
+	T_sink& sink;       //!< Sink to hand the chunks to
+	T_ind* const begin; //!< Beginning of the chunk
+	const T_ind* end;   //!< End of the chunk
+	T_ind* out;         //!< Position to write the next triangle to
+	T_ind left;         //!< Number of triangles the polygon may still have
+
+	//! Write a triangle, handing the chunk to the sink first if it is full
+	void push(const T_ind a, const T_ind b, const T_ind c) {
+#ifndef FMT_NOEXCEPT
+		if (!left)
+			throw std::length_error("Triangulation has more than n - 2 triangles. Is the polygon simple?");
+#endif
+		--left;
+		if (out == end) flush();
+		*(out++) = a;
+		*(out++) = b;
+		*(out++) = c;
+	}
+
+	//! Hand the triangles collected so far to the sink
+	void flush() {
+		if (out == begin) return;
+		sink(static_cast<const T_ind*>(begin), T_ind(out - begin));
+		out = begin;
+	}
+};
+} // namespace _
+} // namespace fmt
+#endif
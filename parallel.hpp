@@ -0,0 +1,219 @@
+#ifndef FMT_PARALLEL_H
+#define FMT_PARALLEL_H
+
+/* Defines a minimal work-stealing parallel loop used by the multi-threaded entry points */
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+#ifndef FMT_NO_THREADS
+#	include <condition_variable>
+#	include <cstdint>
+#	include <mutex>
+#	include <thread>
+#endif
+
+#ifndef FMT_NOEXCEPT
+#	include <exception>
+#endif
+
+namespace fmt {
+namespace _ {
+
+/*! Range of work items owned by one thread. Padded to a cache line to avoid false sharing.
+
+	Items are counted in std::size_t rather than the index type, so that claiming a chunk past the
+	end of a range cannot wrap around into items claimed before.
+*/
+struct WorkRange {
+	std::atomic<std::size_t> next; //!< Next unclaimed item, claimed by the owner and by thieves alike
+	std::size_t end;               //!< End of the range
+	char pad[64 - sizeof(std::atomic<std::size_t>) - sizeof(std::size_t)];
+};
+
+//! Get the number of threads to use if the caller passed 0
+inline unsigned default_threads() {
+#ifndef FMT_NO_THREADS
+	const unsigned threads = std::thread::hardware_concurrency();
+	return threads ? threads : 1;
+#else
+	return 1;
+#endif
+}
+
+#ifndef FMT_NO_THREADS
+/*! Threads kept between calls of parallel_for. Not meant for external use.
+
+	Starting and joining threads costs tens of microseconds, which adds up when every frame
+	triangulates or partitions on several threads. The pool starts its threads on first use and
+	keeps them waiting for the next job until the program exits. One job runs at a time; a caller
+	which finds the pool busy, e.g. on another thread of the application or in a parallel_for
+	nested in a running job, gets false from run and starts threads of its own.
+*/
+class ThreadPool {
+	std::mutex mutex;
+	std::condition_variable wake; //!< Signals a new job or shutdown to the workers
+	std::condition_variable done; //!< Signals the caller that the last worker finished its share
+	std::vector<std::thread> workers;
+
+	void (*job)(void*, unsigned) = nullptr; //!< Job of the current generation, called with data
+	void* data = nullptr;
+	unsigned participants = 0; //!< Number of threads of the job, including the caller
+	unsigned pending = 0;      //!< Workers which have not finished their share of the job yet
+	uint64_t generation = 0;   //!< Number of jobs started
+	bool stopping = false;
+
+	//! Set by the caller of the running job. A flag rather than a mutex, as a nested call tests it
+	//! on the thread which set it.
+	std::atomic<bool> busy{false};
+
+	//! Loop of worker w, which runs as thread w + 1 of each job with enough participants
+	void serve(const unsigned w) {
+		uint64_t seen = 0;
+		std::unique_lock<std::mutex> lock(mutex);
+		while (true) {
+			wake.wait(lock, [this, seen]() { return stopping || generation != seen; });
+			if (stopping) return;
+			seen = generation;
+			if (w + 1 >= participants) continue;
+			lock.unlock();
+			job(data, w + 1);
+			lock.lock();
+			if (--pending == 0) done.notify_one();
+		}
+	}
+
+public:
+	ThreadPool() = default;
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	~ThreadPool() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		wake.notify_all();
+		for (auto&& it = workers.begin(); it != workers.end(); ++it)
+			it->join();
+	}
+
+	/*! Run fn(thread) for every thread in [0, threads), thread 0 on the calling thread.
+
+		@return false without running anything if the pool is running another job.
+	*/
+	template<class T_fn>
+	bool run(const unsigned threads, T_fn& fn) {
+		bool idle = false;
+		if (!busy.compare_exchange_strong(idle, true, std::memory_order_acquire)) return false;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			while (workers.size() + 1 < threads)
+				workers.emplace_back(&ThreadPool::serve, this, unsigned(workers.size()));
+			job = [](void* fn, const unsigned thread) { (*static_cast<T_fn*>(fn))(thread); };
+			data = &fn;
+			participants = threads;
+			pending = threads - 1;
+			++generation;
+		}
+		wake.notify_all();
+		fn(0u);
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			done.wait(lock, [this]() { return pending == 0; });
+		}
+		busy.store(false, std::memory_order_release);
+		return true;
+	}
+};
+
+//! Get the thread pool shared by all calls of parallel_for
+inline ThreadPool& thread_pool() {
+	static ThreadPool pool;
+	return pool;
+}
+#endif
+
+/*! Run fn over all items in [0, count) on the given number of threads.
+
+	Each thread owns a contiguous share of the items and claims chunks of grain items from the front
+	of it. A thread which has exhausted its share steals chunks from the shares of the other threads,
+	so that uneven work is balanced without a central queue. The calling thread takes part as thread
+	0. fn is called as fn(begin, end, thread) for each chunk. If any call throws, the first exception
+	is rethrown on the calling thread once all threads have finished. If FMT_NO_THREADS is defined,
+	all items are processed on the calling thread.
+
+	The other threads are taken from _::thread_pool, so that only the first call pays for starting
+	them. If the pool is busy, e.g. with a call from another application thread or with the call
+	this one is nested in, the call starts and joins threads of its own. Fewer items than one grain run on the calling thread alone.
+*/
+template<class T_ind, class T_fn>
+void parallel_for(const T_ind count, const T_ind grain, unsigned threads, T_fn&& fn) {
+#ifndef FMT_NO_THREADS
+	if (!threads) threads = default_threads();
+	const std::size_t chunks = std::size_t(count) / grain + (std::size_t(count) % grain != 0);
+	threads = unsigned(std::max<std::size_t>(1, std::min<std::size_t>(threads, chunks)));
+#else
+	threads = 1;
+#endif
+
+	if (threads == 1) {
+		for (std::size_t begin = 0; begin < count; begin += grain)
+			fn(T_ind(begin), T_ind(std::min<std::size_t>(begin + grain, count)), 0u);
+		return;
+	}
+
+#ifndef FMT_NO_THREADS
+	std::vector<WorkRange> ranges(threads);
+	for (unsigned t = 0; t < threads; ++t) {
+		ranges[t].next = std::size_t(count) / threads * t;
+		ranges[t].end = t + 1 == threads ? std::size_t(count) : std::size_t(count) / threads * (t + 1);
+	}
+
+#	ifndef FMT_NOEXCEPT
+	std::exception_ptr error;
+	std::atomic<bool> failed(false);
+#	endif
+
+	auto work = [&](const unsigned thread) {
+		for (unsigned k = 0; k < threads; ++k) {
+			WorkRange& range = ranges[(thread + k) % threads];
+			for (std::size_t begin = range.next.fetch_add(grain); begin < range.end;
+					 begin = range.next.fetch_add(grain)) {
+				const T_ind first = T_ind(begin),
+										last = T_ind(std::min<std::size_t>(begin + grain, range.end));
+#	ifndef FMT_NOEXCEPT
+				if (failed) return;
+				try {
+					fn(first, last, thread);
+				} catch (...) {
+					if (!failed.exchange(true)) error = std::current_exception();
+					return;
+				}
+#	else
+				fn(first, last, thread);
+#	endif
+			}
+		}
+	};
+
+	if (!thread_pool().run(threads, work)) {
+		std::vector<std::thread> workers;
+		workers.reserve(threads - 1);
+		for (unsigned t = 1; t < threads; ++t)
+			workers.emplace_back(work, t);
+		work(0);
+		for (auto&& it = workers.begin(); it != workers.end(); ++it)
+			it->join();
+	}
+
+#	ifndef FMT_NOEXCEPT
+	if (error) std::rethrow_exception(error);
+#	endif
+#endif
+}
+} // namespace _
+} // namespace fmt
+#endif
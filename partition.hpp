@@ -2,14 +2,18 @@
 #define FMT_PARTITION_H
 // Defines helper methods and structs for the partition algorithm in ./partition.ipp
 
+#include <algorithm>
 #include <cstdint>
-#include <forward_list>
+#include <cstring>
+#include <limits>
+#include <type_traits>
 #include <vector>
 
 #ifdef DEBUG
 #	include <iostream>
 #endif
 
+#include "predicates.hpp"
 #include "rb_interval.hpp"
 
 namespace fmt {
@@ -23,106 +27,195 @@ struct MonoPart;
 
 // Detail namespace
 namespace _ {
+//! Index used to terminate linked lists of indices
+template<class T_ind>
+constexpr inline T_ind null_index() {
+	return std::numeric_limits<T_ind>::max();
+}
+
 // start at 1 so type is always truthy (since logically both STOP and NORMAL would have to be falsy)
 enum VertexType : uint_fast8_t { STOP = 1, START = 2, MERGE = 3, SPLIT = 4, NORMAL = 5 };
 
-/*! Handles generalised event vertices with pointers for inner doubly-linked lists to track
+/*! Handles generalised event vertices with indices for inner doubly-linked lists to track
 	diagonals on the main chain.
 
-	Contains a void* to a data object of either MergeVertex or SplitVertex. Equally,
-	these data structs should contain a valid reference to their EventVertex. This solution may not be
-	the most elegant, but it works with (almost) zero runtime cost.
+	Contains the index of a data object of type MergeVertex in the set of merge vertices. Equally,
+	these data structs contain the index of their EventVertex. Links are stored as indices into the
+	set of event vertices rather than as pointers, so that the set may grow without invalidating
+	them.
 */
 template<class T_ind>
 struct EventVertex {
-	const T_ind index; //!< index of this vertex in the polygon
-	VertexType type;   //!< type of the vertex
+	T_ind index;     //!< index of this vertex in the polygon
+	VertexType type; //!< type of the vertex
 
-	void* data; //!< pointer to a struct (MergeVertex or SplitVertex)
-
-	template<class T_data>
-	T_data* get_data() const {
-		return static_cast<T_data*>(data);
-	}
+	T_ind data; //!< index of the data struct (MergeVertex) in its set
 
-	EventVertex<T_ind>*next, *prev; //!< Links for inner linked lists.
+	T_ind next, prev; //!< Links for inner linked lists as indices into the set of event vertices.
 
-	//! Construct a new vertex and point the previous vertex to this one
-	EventVertex(const T_ind index, EventVertex<T_ind>* prev, const VertexType type)
-			: index(index), prev(prev), type(type) {
-		if (prev) prev->next = this;
-	}
+	T_ind next_start; //!< Links start vertices attached to the same split vertex
 
-	EventVertex(const T_ind index, VertexType type) : index(index), type(type) {}
+	EventVertex(const T_ind index, const T_ind next, const T_ind prev, const VertexType type)
+			: index(index), type(type), data(T_ind(0)), next(next), prev(prev),
+				next_start(null_index<T_ind>()) {}
 };
 
 template<class T_ind>
 struct MergeVertex {
-	EventVertex<T_ind>& event; //!< Store reference to EventVertex struct
+	T_ind event; //!< Index of the EventVertex struct
 	MonoPart<T_ind>*part_above, *part_below; //!< Pointers to upper and lower parts
 
-	MergeVertex(EventVertex<T_ind>& event) : event(event) { event.data = static_cast<void*>(this); }
+	MergeVertex(const T_ind event) : event(event), part_above(nullptr), part_below(nullptr) {}
+};
+
+// Entry of the queue of parts to be stepped during the sweep: the part is stepped once the sweep
+// reaches vertex vert
+template<class T_ind>
+struct Wake {
+	T_ind vert;             //!< Index of the next event of the part in the polygon
+	MonoPart<T_ind>* part; //!< Part to be stepped
 };
 
 // Split vertex needs to contain a reference to itself in the chain and all start vertices to the
 // left of it.
 template<class T_vert, class T_ind>
 struct SplitVertex {
-	EventVertex<T_ind>& event; //!< Store reference to EventVertex struct
+	T_ind event; //!< Index of the EventVertex struct
 
 	//! cache x and y coordinates (uses more memory, reduces number of dereferences)
 	const T_vert x, y;
 
-	std::forward_list<EventVertex<T_ind>*> starts; //!< allow start vertices to hook into split vertex
+	//! allow start vertices to hook into split vertex. Index of the first start vertex, further
+	//! start vertices are linked through EventVertex::next_start.
+	T_ind starts;
 
-	SplitVertex(EventVertex<T_ind>& event, const T_vert x, const T_vert y, const T_ind reserve)
-			: event(event), x(x), y(y) {
-		event.data = static_cast<void*>(this);
+	SplitVertex(const T_ind event, const T_vert x, const T_vert y)
+			: event(event), x(x), y(y), starts(null_index<T_ind>()) {}
 
-		// starts.reserve(reserve);
-		// TODO: Custom allocator function to reserve starts list
+	//! Attach a start vertex to this split vertex
+	void push_start(std::vector<EventVertex<T_ind>>& evs, const T_ind start) {
+		evs[start].next_start = starts;
+		starts = start;
 	}
-
-	// Operators for quicksort. They are very constant.
-	constexpr inline bool operator<=(const SplitVertex& rhs) const { return x <= rhs.x; }
-	constexpr inline bool operator>=(const SplitVertex& rhs) const { return x >= rhs.x; }
 };
 
-// Basically z-component of cross multiplication
-template<class T>
-constexpr inline bool is_reflex(const T v1, const T v2, const T v3) {
-	return ((v2->x - v1->x) * (v3->y - v1->y) - (v2->y - v1->y) * (v3->x - v1->x)) > 0;
+// Sweep order of two points: by x, then by y. Breaking ties in x by y acts like a sweep line rotated
+// by an infinitesimal angle, so that no two distinct vertices are ever swept at the same time.
+template<class T_vert>
+constexpr inline bool is_before(const T_vert x1, const T_vert y1, const T_vert x2, const T_vert y2) {
+	return x1 < x2 || (x1 == x2 && y1 < y2);
 }
 
-// Quicksort implementation using system stack recursion.
-template<class T_vert, class T_ind>
-inline void qsort(std::vector<SplitVertex<T_vert, T_ind>*>& vec, const T_ind left,
-									const T_ind right) {
-	// Create tmp value, cache pivot (center), etc
-	SplitVertex<T_vert, T_ind>* tmp = vec[left];
-	T_ind i = left, j = right;
-	const T_ind piv_idx = (left + right) / T_ind(2);
-	const SplitVertex<T_vert, T_ind>& piv = *vec[piv_idx];
-
-	// Standard quicksort algorithm
-	while (i < j) {
-		while (i < piv_idx && *vec[i] <= piv)
-			++i;
-		while (j > piv_idx && *vec[j] >= piv)
-			--j;
-		if (i < j) {
-			tmp = vec[i];
-			vec[i] = vec[j];
-			vec[j] = tmp;
-			++i;
-			--j;
-			continue;
+// Basically z-component of cross multiplication, evaluated exactly, see _::orientation
+template<class T_vert>
+inline bool is_reflex(const T_vert x1, const T_vert y1, const T_vert x2, const T_vert y2,
+											const T_vert x3, const T_vert y3) {
+	return orientation(x1, y1, x2, y2, x3, y3) > 0;
+}
+
+/*! Maps coordinates to unsigned integer keys of the same order for radix sorting.
+
+	Defined for IEEE 754 float and double, whose bit patterns order like sign-magnitude integers,
+	and for integral coordinates. Other types set is_radix to false and are sorted by comparison.
+*/
+template<class T_vert, class = void>
+struct RadixKey {
+	static constexpr bool is_radix = false;
+	typedef uint_fast8_t type;
+	static type get(const T_vert) { return type(0); }
+};
+
+template<class T_vert>
+struct RadixKey<T_vert, typename std::enable_if<std::is_integral<T_vert>::value>::type> {
+	static constexpr bool is_radix = true;
+	typedef typename std::make_unsigned<T_vert>::type type;
+	static type get(const T_vert x) {
+		// flip the sign bit so that negative values order first
+		return std::is_signed<T_vert>::value
+							 ? type(x) ^ (type(1) << (std::numeric_limits<type>::digits - 1))
+							 : type(x);
+	}
+};
+
+template<class T_vert, class T_bits>
+struct FloatRadixKey {
+	static constexpr bool is_radix = std::numeric_limits<T_vert>::is_iec559;
+	typedef T_bits type;
+	static type get(const T_vert x) {
+		type bits;
+		std::memcpy(&bits, &x, sizeof(bits));
+		// negative values order reversed, so flip all their bits. Else only flip the sign bit.
+		const type sign = type(1) << (std::numeric_limits<type>::digits - 1);
+		return bits & sign ? ~bits : bits | sign;
+	}
+};
+
+template<>
+struct RadixKey<float> : FloatRadixKey<float, uint32_t> {};
+template<>
+struct RadixKey<double> : FloatRadixKey<double, uint64_t> {};
+
+/*! Sort the first count items of vec by the x coordinate given by get_x.
+
+	Uses an LSD radix sort on 8 bit digits of the keys given by RadixKey, skipping digits which are
+	equal for all keys. This takes Θ(n) for n items regardless of the distribution of x, including
+	many equal x as found on axis-aligned inputs, and is stable. Few items and types without radix
+	keys are sorted by std::sort, an introsort with guaranteed Θ(n log n) and bounded recursion
+	depth. The scratch vectors are only used by the radix sort.
+*/
+template<class T_vert, class T_ind, class T_item, class T_get_x>
+void sort_by_x(std::vector<T_item>& vec, const T_ind count, const T_get_x& get_x,
+							 std::vector<T_item>& scratch, std::vector<typename RadixKey<T_vert>::type>& keys,
+							 std::vector<typename RadixKey<T_vert>::type>& key_scratch) {
+	typedef typename RadixKey<T_vert>::type T_key;
+	constexpr unsigned digits = sizeof(T_key);
+
+	// Below this, the histograms cost more than comparing
+	constexpr T_ind min_radix = T_ind(128);
+
+	if (!RadixKey<T_vert>::is_radix || count < min_radix) {
+		std::sort(vec.begin(), vec.begin() + count,
+							[&get_x](const T_item& a, const T_item& b) { return get_x(a) < get_x(b); });
+		return;
+	}
+
+	keys.resize(count);
+	key_scratch.resize(count);
+	scratch.resize(count);
+
+	// Count all digits in one pass
+	T_ind counts[digits][256] = {};
+	for (T_ind i = T_ind(0); i < count; ++i) {
+		const T_key key = RadixKey<T_vert>::get(get_x(vec[i]));
+		keys[i] = key;
+		for (unsigned d = 0; d < digits; ++d)
+			++counts[d][(key >> (8 * d)) & 0xff];
+	}
+
+	T_item *src = vec.data(), *dst = scratch.data();
+	T_key *key_src = keys.data(), *key_dst = key_scratch.data();
+	for (unsigned d = 0; d < digits; ++d) {
+		const unsigned shift = 8 * d;
+		T_ind* const offsets = counts[d];
+		if (offsets[(key_src[0] >> shift) & 0xff] == count) continue; // all keys share this digit
+
+		T_ind sum = T_ind(0);
+		for (unsigned b = 0; b < 256; ++b) {
+			const T_ind c = offsets[b];
+			offsets[b] = sum;
+			sum += c;
 		}
+
+		for (T_ind i = T_ind(0); i < count; ++i) {
+			const T_ind to = offsets[(key_src[i] >> shift) & 0xff]++;
+			dst[to] = src[i];
+			key_dst[to] = key_src[i];
+		}
+		std::swap(src, dst);
+		std::swap(key_src, key_dst);
 	}
 
-	// Recurse on the system stack
-	if (left < j - 1) qsort(vec, left, j);
-	if (i < right - 1) qsort(vec, i, right);
+	if (src != vec.data()) std::copy(src, src + count, vec.data());
 }
 
 #ifdef DEBUG
@@ -140,34 +233,57 @@ void report_vector_reallocation(const T_vec& vec, const char* vecname, const T_i
 /*! Helper struct used returned by Polygon::partition that indicates a monotone region starting at
 	the index in head.
 
-	Note that the pointers to upper and lower events as well as the RB Tree node pointer are invalid
-	outside the context of the partition function. Also, the active flag is meaningless outside of
-	this context.
+	The part is triangulated by walking its upper chain from first_upper along the next links and its
+	lower chain from first_lower along the previous links of the polygon, up to tail. The first
+	vertices are kept in the part as the links of head may belong to another part that passes it.
+
+	Note that the indices of upper and lower events, the last vertices passed as well as the RB Tree
+	node index are invalid outside the context of the partition function. Also, the active flag is
+	meaningless outside of this context.
 */
 template<class T_ind>
 struct MonoPart {
 	const T_ind head; //!< Index in the polygonal chain where the part starts
 	T_ind tail;       //!< Index of the stop vertex ending the part
 
-	_::EventVertex<T_ind>*upper, *lower; //!< Pointers to events on the upper and lower chain
+	T_ind first_upper, first_lower; //!< Vertices following head on the upper and lower chain
 
-	bool active = false; //!< Ugly hack for lazy deletion from active set
+	T_ind upper, lower;           //!< Indices of the last events passed on the upper and lower chain
+	T_ind last_upper, last_lower; //!< Last vertices passed on the upper and lower chain
 
-	void* node = nullptr; //!< Reference node in RB Interval tree
+	bool active = false; //!< Cleared when the part ends, its entries left in the sweep are skipped
 
-	//! Get node by casting to appropriate pointer type
-	template<class T_vert, class T_data>
-	typename _::RB_Interval<T_vert, T_data, T_ind>::Node* get_node() const {
-		return static_cast<typename _::RB_Interval<T_vert, T_data, T_ind>::Node*>(node);
-	}
+	_::RB_Link node = 0; //!< Reference node in RB Interval tree, 0 if not inserted
 
 	//! Construct new MonoPart
 	//!
 	//! @param head: Index of the starting vertex.
-	//! @param upper: Pointer to the part's upper EventVertex
-	//! @param lower: Pointer to the part's lower EventVertex
-	MonoPart(const T_ind head, _::EventVertex<T_ind>* upper, _::EventVertex<T_ind>* lower)
-			: head(head), upper(upper), lower(lower) {}
+	//! @param first_upper: Index of the vertex following head on the upper chain
+	//! @param first_lower: Index of the vertex following head on the lower chain
+	//! @param upper: Index of the part's upper EventVertex
+	//! @param lower: Index of the part's lower EventVertex
+	MonoPart(const T_ind head, const T_ind first_upper, const T_ind first_lower, const T_ind upper,
+					 const T_ind lower)
+			: head(head), tail(head), first_upper(first_upper), first_lower(first_lower), upper(upper),
+				lower(lower), last_upper(head), last_lower(head) {}
+};
+
+/*! Exported partition of a polygon into monotone parts.
+
+	Consists of the diagonals, stored as the links of all vertices which are not linked to their
+	neighbours on the polygon, and the first and last vertex of each part together with the vertices
+	following the first one on either chain. All members are flat arrays of indices, so that a
+	partition can be written to and read from a file directly.
+	See fmt::Polygon::export_partition.
+*/
+template<class T_ind>
+struct Partition {
+	T_ind size = T_ind(0);    //!< Number of vertices of the partitioned polygon
+	std::vector<T_ind> links; //!< Triples of a vertex, its next and its previous vertex
+	std::vector<T_ind> heads;  //!< First vertex of each monotone part
+	std::vector<T_ind> tails;  //!< Last vertex of each monotone part
+	std::vector<T_ind> uppers; //!< Vertex following the head on the upper chain of each part
+	std::vector<T_ind> lowers; //!< Vertex following the head on the lower chain of each part
 };
 } // namespace fmt
 #endif
@@ -5,84 +5,227 @@
  * It consists solely of the function fmt::partition.
  */
 
-#include "bst.hpp" // actually not a bst but an interval tree
+#include "directions.hpp" // vectorised edge directions
+#include "eytzinger.hpp" // flat search tree over the sorted splits
 #include "partition.hpp"
 #include "polygon.hpp"
 #include "rb_interval.hpp" // red-black interval tree
 
 #include <algorithm>
-#include <forward_list>
-#include <list>
 
 namespace fmt {
 
 template<class T_vert, class T_ind>
-typename std::vector<MonoPart<T_ind>>*
-		Polygon<T_vert, T_ind>::partition(T_ind frac_starts, T_ind frac_merges, T_ind frac_splits,
-																			T_ind frac_stops) {
+void Polygon<T_vert, T_ind>::find_events(Workspace<T_vert, T_ind>& ws) const {
+	const T_ind n = size();
+	std::vector<_::EventVertex<T_ind>>& evs = ws.evs;
+	std::vector<_::MergeVertex<T_ind>>& ev_merges = ws.ev_merges;
+	std::vector<T_ind>& ev_starts = ws.ev_starts;
+	std::vector<_::SplitVertex<T_vert, T_ind>>& split_pool = ws.ev_splits;
+
+	// Direction of each edge in index order
+	std::vector<uint64_t>& directions = ws.directions;
+	directions.assign(n / 64 + 1, uint64_t(0));
+	_::edge_directions(x_data, y_data, stride, n, directions.data());
+
+	// Handle a vertex where the x-direction changes, given the new direction
+	auto push_event = [&](const T_ind i, const T_ind i_prev, const T_ind i_next,
+												const bool sweeping_right) {
+		const T_ind this_ev = evs.size();
+		// reflex angle around i
+		if (_::is_reflex(x(i_prev), y(i_prev), x(i), y(i), x(i_next), y(i_next)))
+			if (!sweeping_right) { // Now sweeping LEFT!
+				evs.emplace_back(i, this_ev + 1, this_ev - 1, _::MERGE);
+				evs.back().data = ev_merges.size();
+				ev_merges.emplace_back(this_ev);
+			} else { // Now sweeping RIGHT!
+				evs.emplace_back(i, this_ev + 1, this_ev - 1, _::SPLIT);
+				split_pool.emplace_back(this_ev, x(i), y(i));
+			}
+		else if (sweeping_right) { // Now sweeping RIGHT!
+			evs.emplace_back(i, this_ev + 1, this_ev - 1, _::START);
+			ev_starts.push_back(this_ev);
+		} else
+			evs.emplace_back(i, this_ev + 1, this_ev - 1, _::STOP);
+	};
+
+	// Sweep each ring on its own. Holes need no special treatment: their leftmost and rightmost
+	// vertices are reflex and become split and merge vertices.
+	for (auto&& it_r = ring_offsets.cbegin(); it_r + 1 != ring_offsets.cend(); ++it_r) {
+		const T_ind first = *it_r, last = *(it_r + 1) - 1;
+		const T_ind first_ev = evs.size();
+
+		// Begin sweeping. The edge closing the ring is not in index order.
+		const bool closing_right = before(last, first);
+		bool sweeping_right = closing_right; // track current sweep direction (edge into i)
+
+		for (T_ind i = first; i < last;) {
+			// The direction changes at the vertices whose bit differs from the one below it
+			const T_ind shift = i % 64, span = std::min(T_ind(64 - shift), T_ind(last - i));
+			const uint64_t word = directions[i / 64] >> shift;
+			uint64_t turns = word ^ ((word << 1) | uint64_t(sweeping_right));
+			if (span < 64) turns &= (uint64_t(1) << span) - 1;
+
+			for (; turns; turns &= turns - 1) {
+				const T_ind turn = i + _::lowest_bit(turns);
+				push_event(turn, turn == first ? last : turn - 1, turn + 1, (word >> (turn - i)) & 1);
+			}
+			sweeping_right = (word >> (span - 1)) & 1;
+			i += span;
+		}
+		if (closing_right != sweeping_right)
+			push_event(last, last == first ? first : last - 1, first, closing_right);
+
+		// Event vertices are linked in the order they are found in. Close the links of the ring.
+		evs.back().next = first_ev;
+		evs[first_ev].prev = evs.size() - 1;
+	}
+
+	_::count(ws.stats.starts, ev_starts.size());
+	_::count(ws.stats.merges, ev_merges.size());
+	_::count(ws.stats.splits, split_pool.size());
+	_::count(ws.stats.stops, evs.size() - ev_starts.size() - ev_merges.size() - split_pool.size());
+}
+
+template<class T_vert, class T_ind>
+bool Polygon<T_vert, T_ind>::keep_monotone(Workspace<T_vert, T_ind>& ws) {
+	if (!ws.ev_splits.empty() || !ws.ev_merges.empty()) return false;
+
+	// Without split and merge vertices, every start vertex heads a part which runs along both of
+	// its chains up to the next event, the stop vertex closing it. As each hole adds a split
+	// vertex, this is exactly the case for an x-monotone polygon, which has one start vertex.
+	std::vector<MonoPart<T_ind>>& parts = ws.parts;
+	for (auto&& it = ws.ev_starts.cbegin(); it != ws.ev_starts.cend(); ++it) {
+		const T_ind head = ws.evs[*it].index;
+		parts.emplace_back(head, nexts[head], prevs[head], *it, *it);
+		parts.back().tail = ws.evs[ws.evs[*it].next].index;
+	}
+
+	this->parts.clear();
+	for (auto&& it = parts.cbegin(); it != parts.cend(); ++it)
+		this->parts.push_back(*it);
+
+	has_valid_diagonals = true;
+	has_valid_part_map = false;
+	_::count(ws.stats.monotone);
+	ws.lap(SWEEP);
+	return true;
+}
+
+template<class T_vert, class T_ind>
+void Polygon<T_vert, T_ind>::order_splits(Workspace<T_vert, T_ind>& ws) const {
+	std::vector<_::EventVertex<T_ind>>& evs = ws.evs;
+	std::vector<T_ind>& ev_starts = ws.ev_starts;
+	std::vector<_::SplitVertex<T_vert, T_ind>>& split_pool = ws.ev_splits;
+
+	// Dummy to attach starts behind last split, swept after every vertex. Note that the event
+	// pointed to is meaningless
+	split_pool.emplace_back(evs.size() - 1, _::Coord<T_vert>::beyond(), _::Coord<T_vert>::beyond());
+
+	// Sort pointers to the split data, so that the data itself stays in place
+	std::vector<_::SplitVertex<T_vert, T_ind>*>& ev_splits = ws.split_order;
+	ev_splits.reserve(split_pool.size());
+	for (auto&& it = split_pool.begin(); it != split_pool.end(); ++it)
+		ev_splits.push_back(&*it);
+
+	// Sort split vertices in Θ(s) for s split vertices, see _::sort_by_x. The dummy stays last.
+	auto split_x = [](const _::SplitVertex<T_vert, T_ind>* split) { return split->x; };
+	_::sort_by_x<T_vert, T_ind>(ev_splits, T_ind(ev_splits.size() - 1), split_x, ws.split_scratch,
+															ws.sort_keys, ws.key_scratch);
+
+	// Order runs of equal x by y, and duplicates by index, see _::is_before. Events are found in
+	// index order. Runs are short unless many splits are aligned.
+	for (auto&& it = ev_splits.begin(), last = ev_splits.end() - 1; it != last;) {
+		auto&& run = it + 1;
+		for (; run != last && (*run)->x == (*it)->x; ++run)
+			;
+		if (run - it > 1)
+			std::sort(it, run, [](const _::SplitVertex<T_vert, T_ind>* a,
+														const _::SplitVertex<T_vert, T_ind>* b) {
+				return a->y < b->y || (a->y == b->y && a->event < b->event);
+			});
+		it = run;
+	}
+	ws.lap(SORT);
+
+	// Link start vertices to the first split vertex at or after them in x for handling. A start with
+	// the x of a split but swept after it is activated early, which is harmless as its part has no
+	// extent left of it. Locating each start takes Θ(log s), while sorting all starts and merging
+	// them with the splits takes Θ(k + s) for k start vertices, which pays off once k log s
+	// exceeds s.
+	T_ind depth = T_ind(0);
+	for (T_ind s = ev_splits.size(); s; s >>= 1)
+		++depth;
+
+	if (ev_splits.size() == 1) {
+		// No split vertex exists, attach all to dummy.
+		for (auto&& it = ev_starts.begin(); it != ev_starts.end(); ++it)
+			ev_splits.back()->push_start(evs, *it);
+	} else if (ev_starts.size() * depth >= ev_splits.size()) {
+		// Sort starts in Θ(k) and merge in Θ(k + s). The dummy is right of all starts.
+		auto start_x = [&evs, this](const T_ind start) { return x(evs[start].index); };
+		_::sort_by_x<T_vert, T_ind>(ev_starts, T_ind(ev_starts.size()), start_x, ws.start_scratch,
+																ws.sort_keys, ws.key_scratch);
+
+		auto&& it_split = ev_splits.begin();
+		for (auto&& it = ev_starts.begin(); it != ev_starts.end(); ++it) {
+			const T_vert x_start = start_x(*it);
+			for (; (*it_split)->x < x_start; ++it_split)
+				;
+			(*it_split)->push_start(evs, *it);
+		}
+	} else {
+		// Build flat search tree onto ev_splits in Θ(s) and locate in Θ(k log s)
+		_::Eytzinger<T_vert, _::SplitVertex<T_vert, T_ind>*, T_ind> split_tree(
+				ev_splits, ws.split_tree_keys, ws.split_tree);
+		for (auto&& it = ev_starts.begin(); it != ev_starts.end(); ++it)
+			split_tree.find(x(evs[*it].index))->push_start(evs, *it);
+		_::count(ws.stats.split_lookups, ev_starts.size());
+	}
+
+	ws.lap(LOCATE);
+}
+
+template<class T_vert, class T_ind>
+typename std::vector<MonoPart<T_ind>>&
+		Polygon<T_vert, T_ind>::partition(Workspace<T_vert, T_ind>& ws, T_ind frac_starts,
+																			T_ind frac_merges, T_ind frac_splits, T_ind frac_stops) {
 
 	Polygon<T_vert, T_ind>& poly = *this;
+	const T_ind n = poly.size();
+	ws.clear();
+	ws.start();
 
 	/* Stage 1: Building the event set */
 	/*
-		Step through each vertex consecutively, calculate if the
-		x-direction has changed. If it has, handle the event by
+		Find the x-direction of every edge in one vectorised pass, see
+		_::edge_directions. Then step through the vertices where the
+		direction changes, 64 edges at a time, and handle each such event by
 		determining whether the angle is reflex using vector cross multiplication.
 		From this, determine the type of vertex (either start, merge, split, or
 		end), and push it to the vector. This process takes Θ(n) time.
 	*/
-	std::vector<_::EventVertex<T_ind>> evs;                // set of all event vertices
-	std::vector<_::MergeVertex<T_ind>> ev_merges;          // set of merge vertex data
-	std::vector<_::EventVertex<T_ind>*> ev_starts;         // cache references to start vertices
-	std::vector<_::SplitVertex<T_vert, T_ind>*> ev_splits; // set of split vertex data as pointers
+	std::vector<_::EventVertex<T_ind>>& evs = ws.evs;             // set of all event vertices
+	std::vector<_::MergeVertex<T_ind>>& ev_merges = ws.ev_merges; // set of merge vertex data
+	std::vector<T_ind>& ev_starts = ws.ev_starts;                 // cache indices of start vertices
+	std::vector<_::SplitVertex<T_vert, T_ind>>& split_pool = ws.ev_splits; // split vertex data
 
 	// Guess number of vertex types for initial allocation
-	T_ind g_starts = poly.size() / frac_starts, g_splits = poly.size() / frac_splits,
-				g_merges = poly.size() / frac_merges, g_stops = poly.size() / frac_stops;
+	T_ind g_starts = n / frac_starts, g_splits = n / frac_splits, g_merges = n / frac_merges,
+				g_stops = n / frac_stops;
 
-	g_starts = std::min(g_starts, T_ind(3));
-	g_splits = std::min(g_splits, T_ind(3));
-	g_merges = std::min(g_merges, T_ind(2));
-	g_stops = std::min(g_stops, T_ind(3));
+	g_starts = std::max(g_starts, T_ind(3));
+	g_splits = std::max(g_splits, T_ind(3));
+	g_merges = std::max(g_merges, T_ind(2));
+	g_stops = std::max(g_stops, T_ind(3));
 
 	evs.reserve(g_starts + g_splits + g_merges + g_stops);
 	ev_starts.reserve(g_starts);
 	ev_merges.reserve(g_merges);
-	ev_splits.reserve(g_splits + 1);
-
-	// Begin sweeping
-	bool sweeping_right = poly[0]->x < poly[1]->x; // track current sweep direction
-	T_vert max_x = NULL; // track max x coordinate to append dummy split event
-
-	// TODO: mod rollover without copy
-	// TODO: Don't use mod arithmetic but instead roll over manually for far
-	// better performance
-	for (T_ind idx = T_ind(1); idx <= poly.size(); ++idx) {
-		T_ind i = idx % poly.size();
-		if ((poly[idx - 1]->x < poly[i]->x) != sweeping_right) {
-			sweeping_right = !sweeping_right;
-
-			if (_::is_reflex<Polygon::Vertex*>(poly[idx - 1], poly[i],
-																				 poly[(idx + 1) % poly.size()])) // reflex angle around i
-				if (!sweeping_right) {                                           // Now sweeping LEFT!
-					evs.emplace_back(i, evs.empty() ? nullptr : &evs.back(), _::MERGE);
-					ev_merges.emplace_back(evs.back());
-				} else { // Now sweeping RIGHT!
-					evs.emplace_back(i, evs.empty() ? nullptr : &evs.back(), _::SPLIT);
-					ev_splits.push_back(new _::SplitVertex<T_vert, T_ind>(evs.back(), poly[i]->x, poly[i]->y,
-																																g_starts / g_splits));
-				}
-			else if (sweeping_right) { // Now sweeping RIGHT!
-				evs.emplace_back(i, evs.empty() ? nullptr : &evs.back(), _::START);
-				ev_starts.push_back(&evs.back());
-			} else
-				evs.emplace_back(i, evs.empty() ? nullptr : &evs.back(), _::STOP);
-		}
-		max_x = poly[i]->x > max_x ? poly[i]->x : max_x;
-	}
+	split_pool.reserve(g_splits + 1);
 
-	evs.back().next = &evs.front();
-	evs.front().prev = &evs.back();
+	find_events(ws);
+	ws.lap(EVENTS);
 
 	// Report data on vector reallocation in DEBUG mode to help find more suitable
 	// guess values
@@ -90,278 +233,327 @@ typename std::vector<MonoPart<T_ind>>*
 	_::report_vector_reallocation(evs, "evs", g_starts + g_merges + g_splits + g_stops);
 	_::report_vector_reallocation(ev_starts, "ev_starts", g_starts);
 	_::report_vector_reallocation(ev_merges, "ev_merges", g_merges);
-	_::report_vector_reallocation(ev_splits, "ev_splits", g_splits);
+	_::report_vector_reallocation(split_pool, "ev_splits", g_splits);
 #endif
 
-	/* Stage 2: Building the split set */
-
-	// Sort split vertices in guaranteed Θ(s log s) for s split vertices
-	if (!ev_splits.empty())
-		_::qsort<T_vert, T_ind>(ev_splits, 0, ev_splits.size() - 1); // uses quicksort defined above
-
-	// Dummy to attach starts behind last split. Note that the event pointed to is meaningless
-	ev_splits.push_back(
-			new _::SplitVertex<T_vert, T_ind>(evs.back(), max_x + 1.0f, 0.0f, g_starts / g_splits));
-	ev_splits.shrink_to_fit();
-
-	// Link start vertices to the split vertex after them for handling
-	if (ev_splits.size() != 1) {
-		// Build simple balanced BST onto ev_splits in Θ(s)
-		_::BST<T_vert, _::SplitVertex<T_vert, T_ind>*, T_ind> split_tree =
-				_::BST<T_vert, _::SplitVertex<T_vert, T_ind>*, T_ind>(ev_splits);
-
-		// Locate in Θ(k log s) for k start vertices
-		for (auto&& it = ev_starts.begin(); it != ev_starts.end(); ++it)
-			split_tree.find(poly[(*it)->index]->x)->starts.push_front(*it);
-	} else {
-		// No split vertex exists, attach all to dummy.
-		// ev_splits.back()->starts.reserve(ev_starts.size());
-		// TODO: Write custom allocator to pre-allocate forward list or just use a
-		// vector for better locality as all values are just pointers anyway
+	// x-monotone polygons are a single part, see keep_monotone
+	if (keep_monotone(ws)) return ws.parts;
 
-		for (auto&& it = ev_starts.begin(); it != ev_starts.end(); ++it)
-			ev_splits.back()->starts.push_front(*it);
-	}
+	/* Stage 2: Building the split set, see order_splits */
+	order_splits(ws);
+	std::vector<_::SplitVertex<T_vert, T_ind>*>& ev_splits = ws.split_order;
 
 	/* Stage 3: Core logic: partitioning */
-	auto parts = new std::vector<MonoPart<T_ind>>();
-	parts->reserve(ev_starts.size() + ev_splits.size());
+	// Parts are referenced by pointer during the sweep. Every split vertex adds at most one part, so
+	// reserving one part per start and split vertex keeps them from reallocating.
+	std::vector<MonoPart<T_ind>>& parts = ws.parts;
+	parts.reserve(ev_starts.size() + ev_splits.size());
+
+	// Only parts reaching an event or changed by a split are stepped and updated in the tree: parts
+	// wait in a heap until the sweep reaches their next event, and parts changed since the tree was
+	// last updated are collected in touched. Each event thus costs amortized Θ(log n).
+	std::vector<MonoPart<T_ind>*>& touched = ws.touched;
+	std::vector<_::Wake<T_ind>>& wakes = ws.wakes;
+	auto wake_later = [this](const _::Wake<T_ind>& a, const _::Wake<T_ind>& b) {
+		return before(b.vert, a.vert);
+	};
+
+	// Nodes refer to parts by their index and to each other by index into the pool, which is kept
+	// in the workspace; once grown, the sweep does not allocate.
+	// Nodes keep no keys: the lower chains of the parts in the tree do not cross, so the heights of
+	// the chains at the sweep, interpolated when needed, keep their order between splits. They are
+	// not integral for integral coordinates.
+	typedef typename _::Coord<T_vert>::Real T_real;
+	_::RB_Interval<T_real, T_ind, T_ind> rbtree(ws.part_nodes, ws.free_nodes, ws.stats);
+
+	T_vert sweep_x, sweep_y; // the current split vertex, up to which all parts are stepped
+	T_ind sweep_i;           // its index, or null_index for the dummy
+
+	// Vertices following vert on the chains of a part. The links of the head may belong to another
+	// part passing it, the part keeps its own.
+	auto upper_after = [this](const MonoPart<T_ind>& part, const T_ind vert) {
+		return vert == part.head ? part.first_upper : nexts[vert];
+	};
+	auto lower_after = [this](const MonoPart<T_ind>& part, const T_ind vert) {
+		return vert == part.head ? part.first_lower : prevs[vert];
+	};
+
+	// Step the last vertex passed on a chain up to vertex to_i at (to_x, to_y) in sweep order. Stops
+	// early where a chain turns back, which only happens at a merge vertex still to be resolved.
+	auto advance_upper = [&](MonoPart<T_ind>& part, const T_vert to_x, const T_vert to_y,
+													 const T_ind to_i) {
+		for (T_ind next = upper_after(part, part.last_upper);
+				 !_::is_before(to_x, to_y, to_i, x(next), y(next), next) &&
+				 !before(next, part.last_upper);
+				 next = upper_after(part, next)) {
+			part.last_upper = next;
+			_::count(ws.stats.chain_steps);
+		}
+		return part.last_upper;
+	};
+	auto advance_lower = [&](MonoPart<T_ind>& part, const T_vert to_x, const T_vert to_y,
+													 const T_ind to_i) {
+		for (T_ind next = lower_after(part, part.last_lower);
+				 !_::is_before(to_x, to_y, to_i, x(next), y(next), next) &&
+				 !before(next, part.last_lower);
+				 next = lower_after(part, next)) {
+			part.last_lower = next;
+			_::count(ws.stats.chain_steps);
+		}
+		return part.last_lower;
+	};
+
+	// A merge vertex reached by the parts above and below it is connected to the first vertex right
+	// of it in the region they enclose. If that vertex is right of the sweep, a split vertex may
+	// come first and the merge stays pending. Returns the part continuing past the merge vertex.
+	auto resolve_merge = [&](_::MergeVertex<T_ind>& merge) -> MonoPart<T_ind>* {
+		MonoPart<T_ind>& above = *merge.part_above;
+		MonoPart<T_ind>& below = *merge.part_below;
+		const T_ind vert = evs[merge.event].index;
+
+		const T_ind high = upper_after(above, advance_upper(above, x(vert), y(vert), vert));
+		const T_ind low = lower_after(below, advance_lower(below, x(vert), y(vert), vert));
+		const T_ind merge_to = before(low, high) ? low : high;
+		if (_::is_before(sweep_x, sweep_y, sweep_i, x(merge_to), y(merge_to), merge_to)) return nullptr;
+
+		nexts[vert] = merge_to;
+		prevs[vert] = merge_to;
+		evs[merge.event].type = _::NORMAL;
+		has_diagonals = true;
+
+		if (high == low) { // the stop vertex closing both parts
+			above.active = below.active = false;
+			above.tail = below.tail = merge_to;
+			return nullptr;
+		} else if (merge_to == high) { // the part below takes over the upper chain
+			above.active = false;
+			above.tail = merge_to;
+			below.upper = above.upper;
+			below.last_upper = merge_to;
+			return &below;
+		} else { // the part above takes over the lower chain
+			below.active = false;
+			below.tail = merge_to;
+			above.lower = below.lower;
+			above.last_lower = merge_to;
+			return &above;
+		}
+	};
+
+	// Step a part through its events up to the sweep. Parts end at stop vertices and wait at merge
+	// vertices for the part on their other side. Both parts at a merge are touched once it is reached
+	// from both sides.
+	auto step = [&](MonoPart<T_ind>* part) {
+		while (part && part->active) {
+			const bool waits_upper = evs[part->upper].type == _::MERGE;
+			if (waits_upper || evs[part->lower].type == _::MERGE) {
+				_::MergeVertex<T_ind>& merge =
+						ev_merges[evs[waits_upper ? part->upper : part->lower].data];
+				if (!merge.part_above || !merge.part_below) return; // other part did not arrive yet
+
+				touched.push_back(merge.part_above);
+				touched.push_back(merge.part_below);
+				part = resolve_merge(merge);
+				if (evs[merge.event].type == _::MERGE) return; // pending
+				continue;
+			}
 
-	std::forward_list<MonoPart<T_ind>*> actives;
+			// Take the event swept first next
+			const T_ind ev_upper = evs[part->upper].next, ev_lower = evs[part->lower].prev;
+			const bool is_upper = !before(evs[ev_lower].index, evs[ev_upper].index);
+			const T_ind this_ev = is_upper ? ev_upper : ev_lower;
+			_::EventVertex<T_ind>& this_vert = evs[this_ev];
+			if (_::is_before(sweep_x, sweep_y, sweep_i, x(this_vert.index), y(this_vert.index),
+															 this_vert.index)) return;
+
+			if (this_vert.type == _::STOP) {
+				part->active = false;
+				part->tail = this_vert.index;
+				return;
+			}
+#ifdef DEBUG
+			if (this_vert.type != _::MERGE)
+				throw std::runtime_error("Reached invalid event type during step!");
+#endif
 
-	_::RB_Interval<T_vert, MonoPart<T_ind>*, T_ind> rbtree;
-	std::vector<_::EventVertex<T_ind>> new_starts;
-	new_starts.reserve(ev_splits.size());
+			if (is_upper) {
+				part->upper = this_ev;
+				ev_merges[this_vert.data].part_below = part;
+			} else {
+				part->lower = this_ev;
+				ev_merges[this_vert.data].part_above = part;
+			}
+		}
+	};
+
+	// Whether a part waits above a pending merge vertex. The region it shares with the part below is
+	// kept in the interval tree by the part below only, as both have the same lower chain there.
+	auto waits_above = [&](const MonoPart<T_ind>& part) {
+		return evs[part.lower].type == _::MERGE && ev_merges[evs[part.lower].data].part_below;
+	};
+
+	// Height of the lower chain of a part at the sweep, which orders the parts in the interval tree
+	auto lower_y = [&](MonoPart<T_ind>& part) {
+		const T_ind vert = advance_lower(part, sweep_x, sweep_y, sweep_i);
+		const T_ind next = lower_after(part, vert);
+		const T_real y_vert = T_real(y(vert));
+		if (x(next) == x(vert)) return y_vert; // vertical edge ending at the sweep
+		return y_vert + (T_real(y(next)) - y_vert) * (T_real(sweep_x) - T_real(x(vert))) /
+												(T_real(x(next)) - T_real(x(vert)));
+	};
+	auto key_of = [&](const T_ind part) { return lower_y(parts[part]); };
+
+	// Queue an active part to be stepped at its next event. A part waiting at a merge vertex is woken
+	// by the part on the other side, and a pending merge once the sweep reaches the vertex it is
+	// connected to, which resolve_merge advanced both chains to.
+	auto wake = [&](MonoPart<T_ind>& part) {
+		const bool waits_upper = evs[part.upper].type == _::MERGE;
+		T_ind vert;
+		if (waits_upper || evs[part.lower].type == _::MERGE) {
+			const _::MergeVertex<T_ind>& merge =
+					ev_merges[evs[waits_upper ? part.upper : part.lower].data];
+			if (merge.part_below != &part || !merge.part_above) return;
+
+			const T_ind high = upper_after(*merge.part_above, merge.part_above->last_upper);
+			const T_ind low = lower_after(part, part.last_lower);
+			vert = before(low, high) ? low : high;
+		} else {
+			const T_ind high = evs[evs[part.upper].next].index;
+			const T_ind low = evs[evs[part.lower].prev].index;
+			vert = before(low, high) ? low : high;
+		}
+		wakes.push_back({vert, &part});
+		std::push_heap(wakes.begin(), wakes.end(), wake_later);
+	};
 
 	// Iterate all split vertices (including dummy)
-	for (auto&& it = ev_splits.begin(); it != ev_splits.end() - 1; ++it) {
+	for (auto&& it = ev_splits.begin(); it != ev_splits.end(); ++it) {
 		_::SplitVertex<T_vert, T_ind>& this_split = **it;
+		sweep_x = this_split.x;
+		sweep_y = this_split.y;
+		sweep_i = it == --ev_splits.end() ? _::null_index<T_ind>() : evs[this_split.event].index;
 		// Logic:
-		// 1. Add starts to active set, step up to split and handle merges / stops recursively
-		// 2. Active list now only has currently active parts: update interval tree
-		// 3. Locate split in in interval tree, build diagonal, hand over to next split
-
-		// Add new vertices to active set
-		for (auto&& it_s = this_split.starts.cbegin(); it_s != this_split.starts.cend(); ++it_s) {
-			parts->emplace_back((*it_s)->index, (*it_s)->next, (*it_s)->prev);
-			MonoPart<T_ind>& this_part = parts->back();
-			actives.push_front(&this_part);
-
-			this_part.active = true;
-
-			if ((*it_s)->prev->type == _::MERGE)
-				(*it_s)->prev->template get_data<_::MergeVertex<T_ind>>()->part_above = &this_part;
-			if ((*it_s)->next->type == _::MERGE)
-				(*it_s)->next->template get_data<_::MergeVertex<T_ind>>()->part_below = &this_part;
-
-			// update merge vertices to reflect new part
-			// REMOVED with new in-place tracking system, keeping in case of revert
-			// if ((*it_s)->merge_below) (*it_s)->merge_below.part_above = &this_part;
-			// if ((*it_s)->merge_above) (*it_s)->merge_above.part_below = &this_part;
+		// 1. Add starts, step them and the parts changed by the last split, then the parts whose next
+		//    event is reached, handling merges / stops
+		// 2. Update the interval tree with the touched parts and queue them at their next event
+		// 3. Locate split in interval tree and connect it to the last vertex of its part
+
+		// Add new vertices as parts
+		for (T_ind it_s = this_split.starts; it_s != _::null_index<T_ind>();
+				 it_s = evs[it_s].next_start) {
+			const T_ind head = evs[it_s].index;
+			parts.emplace_back(head, nexts[head], prevs[head], it_s, it_s);
+			parts.back().active = true;
+			touched.push_back(&parts.back());
 		}
 
-		// Step
-		for (auto&& it_p = actives.begin(); it_p != actives.end(); ++it_p) {
-			MonoPart<T_ind>& this_part = **it_p;
+		// Step. Stepping appends the parts at merge vertices to touched, which are stepped with them.
+		for (std::size_t i = 0, end = touched.size(); i < end; ++i)
+			step(touched[i]);
+		while (!wakes.empty() &&
+					 !_::is_before(sweep_x, sweep_y, sweep_i, x(wakes.front().vert), y(wakes.front().vert),
+												 wakes.front().vert)) {
+			MonoPart<T_ind>* part = wakes.front().part;
+			std::pop_heap(wakes.begin(), wakes.end(), wake_later);
+			wakes.pop_back();
+			if (!part->active) continue; // ended since it was queued
+			touched.push_back(part);
+			step(part);
+		}
 
-			if (!this_part.active)
-				continue; // TODO: Reevaluate the necessity of this check with the new
-                  // deletion model
-
-			// Step through each vertex in the part in a while loop so that we can
-			// manually handle deletions and increments. Termination is handled by the
-			// condition in the loop.
-			while (true) {
-				bool is_upper;
-				_::EventVertex<T_ind>* this_vert;
-				if (poly[this_part.upper->index]->x <= poly[this_part.lower->index]->x) {
-					this_vert = this_part.upper->next;
-					is_upper = true;
-				} else {
-					this_vert = this_part.lower->prev;
-					is_upper = false;
-				}
-
-				if (poly[this_vert->index]->x > this_split.x) break;
-
-				if (is_upper)
-					this_part.upper = this_vert;
-				else
-					this_part.lower = this_vert;
-
-				if (this_vert->type == _::NORMAL) continue; // Vertex has been handled by another part
-
-				// Handle vertex types (merge and stop)
-				// If merge, else if stop
-				if (this_vert->type == _::MERGE) {
-					// Logic:
-					// 1. Check whether the vertex with higher x than this vertex on the
-					// upper opposing chain has an x below the current split vertex. 2.a
-					// If it does, set merge_to to that vertex.
-					// 2.b If it does not, repeat for the lower opposing chain.
-					// 3.a If this vertex cannot be merged to either, continue with the
-					// next part. This merge vertex must behandled at the next split
-					// vertex. 3.b Else, a merge_to vertex exist. Merge to it and mark the
-					// current part as done.
-					T_ind merge_to;
-					typename _::EventVertex<T_ind>*upper,
-							*lower; // EventVertex structs above and below the merge vertex
-
-					upper = is_upper
-											? this_vert->template get_data<_::MergeVertex<T_ind>>()->part_above->upper
-											: this_part.upper;
-					lower = is_upper
-											? this_part.lower
-											: this_vert->template get_data<_::MergeVertex<T_ind>>()->part_below->lower;
-
-					// Lambda since C++ doesn't do proper macros very well and moving this
-					// out into a function would become quite confusing.
-					auto check_merge = [&merge_to, &this_vert, &this_split,
-															&poly](const Polygon::Vertex* vertex,
-																		 void (*oprtr)(const Polygon::Vertex*)) {
-						for (; vertex->x <= poly[this_vert->index]->x; oprtr(vertex))
-							; // Step index until a vertex right of the current merge vertex is found
-
-						if (vertex->x > this_split.x) return false; // broke bounds on split vertex
-
-						merge_to = vertex - poly[0];
-						return true;
-					};
-
-					// It would be better to figure out how to pass the operator directly,
-					// but the compiler should inline this so it's effectively the same.
-					bool merged_high = false, merged_low = false;
-					merged_high =
-							check_merge(poly[upper->index], [](const Polygon::Vertex* val) { val = val->next; });
-					if (!merged_high)
-						merged_low = check_merge(poly[lower->index],
-																		 [](const Polygon::Vertex* val) { val = val->prev; });
-
-					if (merged_high || merged_low) {
-						// Merge to merge_to
-						poly.add_diagonal(this_vert->index, merge_to);
-
-						// Update links between EventVertex structs to reflect new diagonal.
-						// First need to locate the next EventVertex after the probably
-						// normal vertex at merge_to.
-						if (merged_high) {
-							for (; poly[upper->index]->x < poly[merge_to]->x; upper = upper->next)
-								;
-							this_vert->next = upper;
-							upper->prev = this_vert;
-						} else {
-							for (; poly[lower->index]->x < poly[merge_to]->x; lower = lower->prev)
-								;
-							this_vert->prev = lower;
-							lower->next = this_vert;
-
-							if (lower->type == _::MERGE)
-								lower->template get_data<_::MergeVertex<T_ind>>()->part_above = &this_part;
-						}
-
-						this_vert->type = _::NORMAL; // Flag as handled
-
-						if ((is_upper && merged_low) || (!is_upper && merged_high)) {
-							this_part.active = false;
-							this_part.tail = merge_to;
-							break; // break out of current part as it is done.
-						}
-
-						if (is_upper)
-							this_vert->next->template get_data<_::MergeVertex<T_ind>>()->part_below =
-									this_vert->template get_data<_::MergeVertex<T_ind>>()->part_below;
-						else
-							this_vert->prev->template get_data<_::MergeVertex<T_ind>>()->part_above =
-									this_vert->template get_data<_::MergeVertex<T_ind>>()->part_above;
-					} // We cannot merge. Continue to next event.
-
-				} else // If not merge, it must be stop
-#ifdef DEBUG   // If debugging, check if remaining vertex is truly stop, else throw exception.
-						if (this_vert->type == _::STOP)
-#endif
-				{ // Stop Vertex
-					this_part.active = false;
-					this_part.tail = this_vert->index;
-					break;
-				}
-#ifdef DEBUG
-				else // Vertex was neither merge nor stop. Something is wrong.
-					throw std::runtime_error("Reached invalid event type during step!");
-#endif
-			} // iteration through this_part
-		}   // iteration through actives
+		if (it == (--ev_splits.end())) break; // All parts end before the dummy
 
 		// Update RB Interval tree
-		// TODO: Consider first iterating for deletion, then iterating for insertion
-		// this would minimize tree lookups at the cost of iterating actives twice.
-		// could also track list of to_delete, delete them, then update actives.
-		auto&& it_p = actives.begin();
-		auto&& it_p_last = actives.before_begin();
-		while (it_p != actives.end()) {
+		// First remove ended parts and parts waiting above a merge, so that insertions descend a tree
+		// whose keys are all current. Parts may be touched more than once.
+		for (auto&& it_p = touched.begin(); it_p != touched.end(); ++it_p) {
 			MonoPart<T_ind>& this_part = **it_p;
-			if (!this_part.active) {
-				if (this_part.node) rbtree.remove(this_part.template get_node<T_vert, MonoPart<T_ind>*>());
-				actives.erase_after(it_p_last);
-				it_p = it_p_last;
-				++it_p;
-				continue;
+			if (this_part.node && (!this_part.active || waits_above(this_part))) {
+				rbtree.remove(this_part.node);
+				this_part.node = 0;
 			}
+		}
+		for (auto&& it_p = touched.begin(); it_p != touched.end(); ++it_p) {
+			MonoPart<T_ind>& this_part = **it_p;
+			if (!this_part.active) continue;
+			if (!this_part.node && !waits_above(this_part))
+				this_part.node =
+						rbtree.insert(lower_y(this_part), T_ind(&this_part - parts.data()), key_of);
+			wake(this_part);
+		}
+		touched.clear();
+
+		MonoPart<T_ind>& to_split = parts[rbtree.find(this_split.y, key_of)];
+		const T_ind split = evs[this_split.event].index;
+		evs[this_split.event].type = _::NORMAL;
+		has_diagonals = true;
+
+		// The split vertex is connected to the last vertex left of it in its part. The part above
+		// continues along its upper edge, which is linked by prevs, the part below along its lower
+		// edge, which is linked by nexts.
+		const bool waits_upper = evs[to_split.upper].type == _::MERGE;
+		if (waits_upper || evs[to_split.lower].type == _::MERGE) {
+			// Pending merge vertex: one diagonal resolves both
+			_::MergeVertex<T_ind>& merge =
+					ev_merges[evs[waits_upper ? to_split.upper : to_split.lower].data];
+			const T_ind vert = evs[merge.event].index;
+			nexts[vert] = split;
+			prevs[vert] = split;
+			evs[merge.event].type = _::NORMAL;
+
+			merge.part_above->lower = this_split.event;
+			merge.part_above->last_lower = split;
+			merge.part_below->upper = this_split.event;
+			merge.part_below->last_upper = split;
+			touched.push_back(merge.part_above);
+			touched.push_back(merge.part_below);
+			continue;
+		}
 
-			T_ind lowest = this_part.lower->index;
-			for (; poly[lowest]->x <= this_split.x; --lowest)
-				;
-
-			if (this_part.node)
-				this_part.template get_node<T_vert, MonoPart<T_ind>*>()->key = poly[lowest]->y;
-			else
-				this_part.node = rbtree.insert(lowest, &this_part);
-
-			++it_p;
-		} // Second iteration through actives
-
-		if (it == (--ev_splits.end())) break; // No need to lookup dummy
-
-		MonoPart<T_ind>* to_split = rbtree.find(this_split.y);
-
-		T_ind upper = to_split->upper->index;
-		T_ind lower = to_split->lower->index;
-
-		for (; poly[upper]->x <= this_split.x; ++upper)
-			;
-		for (; poly[lower]->x <= this_split.x; --lower)
-			;
-
-		_::EventVertex<T_ind>* this_start;
-		if (poly[upper]->x > poly[lower]->x) {
-			// Split to upper
-			new_starts.emplace_back(upper, _::START);
-			this_start = &new_starts.back();
-
-			this_start->next = &this_split.event;
-			this_split.event.prev = this_start;
+		const T_ind high = advance_upper(to_split, sweep_x, sweep_y, sweep_i);
+		const T_ind low = advance_lower(to_split, sweep_x, sweep_y, sweep_i);
+		if (high == to_split.head && low == to_split.head) {
+			// Nothing passed yet: the part is divided at its head
+			parts.emplace_back(to_split.head, split, to_split.first_lower, this_split.event,
+												 to_split.lower);
+			parts.back().last_upper = split;
+
+			to_split.first_lower = split;
+			to_split.lower = this_split.event;
+			to_split.last_lower = split;
+		} else if (low == to_split.head || (high != to_split.head && !before(high, low))) {
+			// Connect to the upper chain. A new part starts there above the diagonal.
+			parts.emplace_back(high, nexts[high], split, to_split.upper, this_split.event);
+			parts.back().last_lower = split;
+
+			nexts[high] = split;
+			to_split.upper = this_split.event;
+			to_split.last_upper = split;
 		} else {
-			// Split to lower
-			new_starts.emplace_back(lower, _::START);
-			this_start = &new_starts.back();
+			// Connect to the lower chain. A new part starts there below the diagonal.
+			parts.emplace_back(low, split, prevs[low], this_split.event, to_split.lower);
+			parts.back().last_upper = split;
 
-			this_start->prev = &this_split.event;
-			this_split.event.next = this_start;
+			prevs[low] = split;
+			to_split.lower = this_split.event;
+			to_split.last_lower = split;
 		}
-		(*(it + 1))->starts.push_front(this_start);
-
-		add_diagonal(this_split.event.index, this_start->index);
-
-		this_split.event.type = _::NORMAL;
+		parts.back().active = true;
+		touched.push_back(&parts.back());
+		touched.push_back(&to_split);
 	} // iteration through splits
 
-	/* Finally: Update flags and do cleanup */
-	// Delete vector of split pointers
-	for (auto it = ev_splits.begin(); it != ev_splits.end(); ++it)
-		delete *it;
+	/* Finally: Keep the parts alongside the diagonals and update flags */
+	// MonoPart is not assignable, so the parts are copied element by element
+	poly.parts.clear();
+	for (auto&& it = parts.cbegin(); it != parts.cend(); ++it)
+		poly.parts.push_back(*it);
 
 	poly.has_valid_diagonals = true;
+	poly.has_valid_part_map = false; // parts kept for incremental updates are superseded
+	ws.lap(SWEEP);
 
-	return parts; // caller must handle cleanup
+	return parts; // owned by the workspace
 }
 } // namespace fmt
 #endif
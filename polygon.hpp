@@ -9,22 +9,29 @@
 #	endif
 #endif
 
-/* Defines a polygon as a vector of vertices
- * Allows polygons to have diagonals, which are represented as a linked list living inside the
- * vertex vector.
+/* Defines a polygon as a structure of arrays of vertex coordinates
+ * Allows polygons to have diagonals, which are represented as linked lists of indices living
+ * alongside the coordinate arrays.
  */
 
+#include "output.hpp"
 #include "partition.hpp"
+#include "workspace.hpp"
 
-#include <memory>
+#include <cstdint>
 #include <vector>
 
+#ifndef FMT_NOEXCEPT
+#	include <stdexcept>
+#endif
+
 //! FastMono Triangulator namespace
 namespace fmt {
 /*! A polygon formed for FastMono triangulation.
 
-	Defines a polygon as a vector of vertices with inner linked list loops forming individual
-	compartemnts as created by inserting diagonals.
+	Defines a polygon as a structure of arrays: the x and y coordinates of all vertices are kept in
+	two contiguous arrays, and the inner linked list loops forming individual compartments as created
+	by inserting diagonals are kept in two separate arrays of indices.
 
 	This class provides the interface to the FastMono algorithm implementation. Since the algorithm
 	relies on attributing vertices with special data, this special polygon class is used. The
@@ -38,11 +45,22 @@ namespace fmt {
 
 template<class T_vert, class T_ind>
 class Polygon {
-public:
-	struct Vertex; // forward declaration
-
 private:
-	std::vector<Vertex*> poly; //!< Vertices of the polygon
+	std::vector<T_vert> xs; //!< x coordinates of the vertices, if owned by the polygon
+	std::vector<T_vert> ys; //!< y coordinates of the vertices, if owned by the polygon
+
+	//! Coordinates as read by the algorithm. Point into xs and ys, or into a caller-owned buffer.
+	const T_vert *x_data = nullptr, *y_data = nullptr;
+	T_ind stride = T_ind(1); //!< Distance in elements between the coordinates of successive vertices
+	T_ind n_verts = T_ind(0); //!< Number of vertices
+	bool is_view = false;     //!< Indicates whether the coordinates are owned by the caller
+
+	//! First vertex of each ring, followed by the number of vertices. The outer ring comes first,
+	//! all further rings are holes.
+	std::vector<T_ind> ring_offsets = std::vector<T_ind>(2, T_ind(0));
+
+	std::vector<T_ind> nexts; //!< Index of the next vertex in the inner linked list of each vertex
+	std::vector<T_ind> prevs; //!< Index of the previous vertex in the inner linked list of each vertex
 
 	bool has_diagonals = false;       //!< Indicates whether the polygon contains any diagonals.
 	bool has_valid_diagonals = false; //!< Indicates whether the current set of diagonals is up-to-date
@@ -50,54 +68,178 @@ private:
 
 	std::vector<T_ind> indices; //!< Caches the latest triangle indices
 
+	std::vector<MonoPart<T_ind>> parts; //!< Monotone parts formed by the current set of diagonals
+
+	bool is_incremental = false;     //!< Indicates whether edits update the parts incrementally
+	bool has_valid_part_map = false; //!< Indicates whether part_offsets and vertex_parts are up-to-date
+
+	std::vector<T_ind> part_offsets; //!< Offset of the indices of each part in indices
+	std::vector<T_ind> vertex_parts; //!< Part of each vertex, null if it bounds more than one
+	std::vector<T_ind> edits;        //!< Vertices edited since the latest triangulation
+
+	bool has_valid_flips = false;  //!< Indicates whether twins and flip_queue fit the indices
+	std::vector<T_ind> twins;      //!< Opposite half-edge of each edge of the triangles, see find_twins
+	std::vector<T_ind> flip_queue; //!< Half-edges whose edge may be illegal, see flip_delaunay
+	std::vector<uint8_t> queued;   //!< Whether each half-edge is in flip_queue
+
 	//! Invalidate the current set of diagonals and indices.
 	//! Convenience function.
 	inline void invalidate() {
 		has_valid_diagonals = false;
 		has_valid_indices = false;
+		has_valid_part_map = false;
+		edits.clear();
 	}
 
 	//! Add a diagonal to the polygon
 	//! Convenience function. Also sets has_diagonals to true.
 	void add_diagonal(const T_ind from, const T_ind to);
 
+	//! Point the coordinates read by the algorithm to the owned coordinate arrays.
+	//! Convenience function. Must be called whenever xs or ys may have reallocated.
+	inline void bind_owned() {
+		x_data = xs.data();
+		y_data = ys.data();
+		stride = T_ind(1);
+		n_verts = xs.size();
+		is_view = false;
+	}
+
+	//! Whether vertex a is swept before vertex b. Duplicate vertices are ordered by index, see
+	//! _::is_before.
+	inline bool before(const T_ind a, const T_ind b) const {
+		return _::is_before(x(a), y(a), a, x(b), y(b), b);
+	}
+
+	unsigned partition_threads = 1; //!< Threads to partition on, see set_partition_threads
+
+	//! Resize the link arrays to the current number of vertices and clear all diagonals.
+	void reset_links();
+
+	//! Find all event vertices, linked in the order of their rings, for Stage 1 of the partition.
+	void find_events(Workspace<T_vert, T_ind>& ws) const;
+
+	//! Keep the polygon as one part per start vertex if the events found by find_events hold no
+	//! split and no merge vertex, which is the case for x-monotone polygons. Skips Stages 2 and 3
+	//! of the partition.
+	//! @return Whether the polygon was kept, else it must be swept.
+	bool keep_monotone(Workspace<T_vert, T_ind>& ws);
+
+	//! Sort the split vertices found by find_events into ws.split_order, followed by a dummy swept
+	//! after every vertex, and attach every start vertex to the first of them at or after it in x,
+	//! for Stage 2 of the partition. The sweep handles the starts attached to a split vertex before
+	//! it, in the order of their list.
+	void order_splits(Workspace<T_vert, T_ind>& ws) const;
+
+	//! Get the vertex following i on its ring. Takes Θ(log h) for h holes.
+	T_ind ring_next(const T_ind i) const;
+	//! Get the vertex preceding i on its ring. Takes Θ(log h) for h holes.
+	T_ind ring_prev(const T_ind i) const;
+
+	//! Copy the coordinates of a view into the owned coordinate arrays.
+	//! Convenience function. Does nothing if the coordinates are owned already.
+	void take_ownership();
+
+	//! Locate each vertex in the monotone parts for incremental updates.
+	//! The parts must have been triangulated into indices in order.
+	void map_parts();
+
+	//! Re-triangulate only the parts containing edited vertices.
+	//! @return false if an edit breaks its part, in which case the polygon must be partitioned anew.
+	bool update_parts(Workspace<T_vert, T_ind>& ws);
+
+	//! Check whether a part is still a simple x-monotone polygon after its vertices were moved
+	bool is_monotone(const MonoPart<T_ind>& part) const;
+
+	//! Find the opposite half-edge of each edge of the triangles in indices. Half-edge e runs from
+	//! indices[e] to the next vertex of triangle e / 3. Edges on the boundary get null_index.
+	void find_twins(std::vector<T_ind>& twins, Workspace<T_vert, T_ind>& ws) const;
+
+	//! Get the number of triangles of a monotone part by walking its chains
+	T_ind part_triangle_count(const MonoPart<T_ind>& part) const;
+
+	//! Triangulate a single monotone part into out, using L as the stack of its reflex chain.
+	//! L must hold at least as many elements as the part has vertices. out is one of the outputs in
+	//! ./output.hpp.
+	template<class T_out>
+	void triangulate_part(const MonoPart<T_ind>& part, T_out& out, T_ind* const L) const;
+
+	//! Write a triangle to out in clockwise orientation.
+	//! Convenience function. a and b are consecutive vertices of the same chain, ordered by x.
+	template<class T_out>
+	inline void push_triangle(T_out& out, const T_ind a, const T_ind b, const T_ind c,
+														const bool on_upper) const {
+		if (on_upper)
+			out.push(a, b, c);
+		else
+			out.push(a, c, b);
+	}
+
 public:
-	/*! A vertex stored as an element of a linked list.
+	/*! A vertex of the polygon.
 
-		Represents a vertex with x, y of type T_vert. Should not be used to represent a single point on
-		a plane.
+		Represents a vertex with x, y of type T_vert. Vertices are returned by value, as the polygon
+		itself does not store them as individual objects.
 	*/
 	struct Vertex {
 		T_vert x, y;
-		Vertex *next = nullptr, *prev = nullptr;
-
-		//! Change the coordinates of the vertex
-		void set(T_vert x, T_vert y) {
-			this->x = x;
-			this->y = y;
-		}
-		//! Change the coordinates and previous link of the vertex. Also updates the previous vertex.
-		void set(T_vert x, T_vert y, Vertex* prev) {
-			this->x = x;
-			this->y = y;
-			this->prev = prev;
-			prev->next = this;
-		}
-
-		//! Construct a new vertex
-		Vertex(T_vert x, T_vert y) : x(x), y(y) {}
-		//! Construct a new vertex. Also updates the previous vertex
-		Vertex(T_vert x, T_vert y, Vertex* prev) : x(x), y(y), prev(prev) { prev->next = this; }
 	};
 
+	//! Construct an empty polygon. Its vertices must be set through set_vertices before use.
+	Polygon() = default;
+
 	/*! Construct a new polygon from an std::vector
 
 		Takes an std::vector where every x is at an even and every y at the succeeding odd index,
 		starting from 0. The vertices are expected to be listed in clockwise(!) orientation. Constructs
-		a new Polygon using fmt::Polygon::Vertex by copy-assignment.
+		a new Polygon by copying the coordinates into its coordinate arrays.
 	*/
 	Polygon(const std::vector<T_vert>& vec);
 
+	/*! Construct a new polygon with holes from an std::vector
+
+		Takes the vertices of all rings in one vector as Polygon(const std::vector<T_vert>&) does. The
+		outer ring comes first and is expected in clockwise(!) orientation, followed by the holes in
+		counter-clockwise orientation, so that the inside of the polygon always lies to the right.
+		See set_holes.
+
+		@param vec Interleaved coordinates of all rings.
+		@param holes Index of the first vertex of each hole, in increasing order.
+	*/
+	Polygon(const std::vector<T_vert>& vec, const std::vector<T_ind>& holes);
+
+	/*! Construct a new polygon over a caller-owned buffer of interleaved coordinates
+
+		Does not copy the coordinates. The vertex at index i is read from xy[i * stride] and
+		xy[i * stride + 1], which allows passing e.g. mapped vertex buffers with additional attributes
+		directly. The vertices are expected to be listed in clockwise(!) orientation. The buffer must
+		outlive the polygon, or the polygon must be given new vertices before it is used again.
+
+		@param xy Pointer to the x coordinate of the first vertex.
+		@param count Number of vertices.
+		@param stride Distance in elements of type T_vert between successive vertices. Defaults to 2.
+	*/
+	Polygon(const T_vert* xy, const T_ind count, const T_ind stride = T_ind(2));
+
+	/*! Construct a new polygon over two caller-owned arrays of x and y coordinates
+
+		Does not copy the coordinates. The vertex at index i is read from x[i * stride] and
+		y[i * stride]. See Polygon(const T_vert*, const T_ind, const T_ind).
+
+		@param x Pointer to the x coordinate of the first vertex.
+		@param y Pointer to the y coordinate of the first vertex.
+		@param count Number of vertices.
+		@param stride Distance in elements of type T_vert between successive vertices. Defaults to 1.
+	*/
+	Polygon(const T_vert* x, const T_vert* y, const T_ind count, const T_ind stride = T_ind(1));
+
+	//! Copy a polygon. Views remain views of the same buffer, owned coordinates are copied.
+	Polygon(const Polygon& other);
+	//! Copy a polygon. Views remain views of the same buffer, owned coordinates are copied.
+	Polygon& operator=(const Polygon& other);
+	Polygon(Polygon&& other) = default;
+	Polygon& operator=(Polygon&& other) = default;
+
 	/*! Update the vertices of the polygon from a vector
 
 		Takes an std::vector where every x is at an even and every y at the succeeding odd index,
@@ -111,27 +253,123 @@ public:
 	*/
 	void set_vertices(const std::vector<T_vert>& vec);
 
+	/*! Update the vertices of the polygon to a caller-owned buffer of interleaved coordinates
+
+		Does not copy the coordinates; see Polygon(const T_vert*, const T_ind, const T_ind). This
+		clears all diagonals of the polygon. Storage for the diagonals is reused if possible.
+		@throws std::invalid_argument If count is less than three.
+	*/
+	void set_vertices(const T_vert* xy, const T_ind count, const T_ind stride = T_ind(2));
+
+	/*! Update the vertices of the polygon to two caller-owned arrays of x and y coordinates
+
+		Does not copy the coordinates; see Polygon(const T_vert*, const T_vert*, const T_ind,
+		const T_ind). This clears all diagonals of the polygon.
+		@throws std::invalid_argument If count is less than three.
+	*/
+	void set_vertices(const T_vert* x, const T_vert* y, const T_ind count,
+										const T_ind stride = T_ind(1));
+
+	/*! Update the vertices of the polygon from a vector of several rings
+
+		Behaves like set_vertices(const std::vector<T_vert>&), followed by set_holes(holes).
+	*/
+	void set_vertices(const std::vector<T_vert>& vec, const std::vector<T_ind>& holes);
+
+	/*! Split the vertices of the polygon into an outer ring and holes
+
+		The vertices up to the first hole form the outer ring in clockwise orientation. Each hole runs
+		from its first vertex up to the first vertex of the next hole, or up to the last vertex, in
+		counter-clockwise orientation. Rings must not intersect each other or themselves. Holes are
+		handled by the partition directly, their vertices become start, split, merge and stop vertices
+		like those of the outer ring; no bridges need to be inserted beforehand.
+
+		Setting the vertices of the polygon through set_vertices resets it to a single ring. This
+		clears all diagonals of the polygon.
+
+		@param holes Index of the first vertex of each hole, in increasing order. Empty for a polygon
+		without holes.
+		@throws std::invalid_argument If a ring has less than three vertices.
+	*/
+	void set_holes(const std::vector<T_ind>& holes);
+
 	/*! Clear all existing diagonals in the polygon
 
-		Updates the inner linked lists of the polygon to reflect the vertice's order in the vector. This
+		Updates the inner linked lists of the polygon to reflect the vertice's order in the arrays. This
 		effectively clears all diagonals inserted by triangulating or partitioning the polygon.
 	 */
 	void clear_diagonals();
 
 	/*! Append a vertex to the polygon
 
-		Takes a fmt::Polygon::Vertex and appends it to the vertex vector of the polygon. Memory
-		management wil be performed by the polygon.
+		Appends a vertex with the given coordinates to the end of the polygon, i.e. between the current
+		last vertex and the first vertex of its ring; this is the outer ring, or the last hole if the
+		polygon has holes. This clears all diagonals of the polygon. If the polygon is a view of
+		a caller-owned buffer, its coordinates are copied into the polygon first.
+	*/
+	void push_back(const T_vert x, const T_vert y);
+
+	/*! Move a vertex of the polygon
+
+		Sets the coordinates of the vertex at index i. If the polygon is a view of a caller-owned
+		buffer, its coordinates are copied into the polygon first. This clears all diagonals of the
+		polygon, unless the polygon is incremental. See fmt::Polygon::set_incremental.
 	*/
-	void push_back(Vertex* v);
+	void set_vertex(const T_ind i, const T_vert x, const T_vert y);
+
+	/*! Enable or disable incremental updates
+
+		An incremental polygon keeps its monotone parts after triangulating. Moving vertices through
+		set_vertex or appending them through push_back then only marks the parts containing these
+		vertices; the next call to get_indices re-triangulates just those parts in place, so that the
+		cost of an edit scales with the size of the parts it touches rather than with the size of the
+		polygon.
+
+		Before a part is re-triangulated, it is checked to still be a simple x-monotone polygon. If
+		an edit breaks this, e.g. because a vertex was moved past its neighbours in x or onto an event
+		vertex or diagonal, the whole polygon is partitioned anew. Keeping the parts takes memory
+		linear in the number of vertices. Disabled by default.
+	*/
+	void set_incremental(const bool incremental);
+
+	/*! Set the number of threads to partition the polygon on
+
+		With more than one thread, get_indices and compute_diagonals partition the polygon through
+		fmt::Polygon::partition_slabs, which cuts it into vertical slabs that are swept in parallel.
+		In all, the slabs take 3 to 5 times the processor time of the single sweep, e.g. 2.1 s
+		against 0.7 s for a star with a million vertices, so they only pay off with many cores to
+		spread them over. The parts found and their order are those of the single-threaded
+		partition, so that the triangulation is the same for any number of threads. 0 uses one thread
+		per hardware thread. Defaults to 1.
+	*/
+	void set_partition_threads(const unsigned threads) { partition_threads = threads; }
+
+	//! Get the number of threads the polygon is partitioned on, see set_partition_threads
+	unsigned get_partition_threads() const { return partition_threads; }
 
 	//! Get the number of vertices in the polygon
-	T_ind size() { return poly.size(); }
+	T_ind size() const { return n_verts; }
+
+	//! Get the number of holes in the polygon
+	T_ind hole_count() const { return ring_offsets.size() - T_ind(2); }
+
+	//! Get the number of triangles in a triangulation of the polygon. Each hole adds two.
+	T_ind triangle_count() const { return n_verts + T_ind(2) * hole_count() - T_ind(2); }
 
 	//! Get the vertex at the specified index
-	Vertex* at(const T_ind i) const { return poly[i]; };
+	Vertex at(const T_ind i) const { return Vertex{x(i), y(i)}; };
 	//! Get the vertex at the specified index
-	Vertex* operator[](const T_ind i) const { return poly[i]; }
+	Vertex operator[](const T_ind i) const { return Vertex{x(i), y(i)}; }
+
+	//! Get the x coordinate of the vertex at the specified index
+	T_vert x(const T_ind i) const { return x_data[i * stride]; }
+	//! Get the y coordinate of the vertex at the specified index
+	T_vert y(const T_ind i) const { return y_data[i * stride]; }
+
+	//! Get the index of the vertex following the specified one in its inner linked list
+	T_ind next(const T_ind i) const { return nexts[i]; }
+	//! Get the index of the vertex preceding the specified one in its inner linked list
+	T_ind prev(const T_ind i) const { return prevs[i]; }
 
 	/*! Compute or retrieve a set of indices forming a triangulation of the polygon.
 
@@ -139,20 +377,218 @@ public:
 		Else, a new set of indices is constructed from the current set of diagonals if they are valid.
 		Else, a new set of diagonals is computed first. The result is cached and returned.
 
-		TODO: Implement incremental calculations
+		If the polygon is incremental and only some parts were edited, just these parts are
+		re-triangulated. See fmt::Polygon::set_incremental.
 
 		@return A vector of indices, where each successive three elements indicate the indices of a
 		triangle.
 	*/
 	const std::vector<T_ind>& get_indices();
 
+	/*! Compute or retrieve a set of indices forming a triangulation of the polygon.
+
+		Behaves like fmt::Polygon::get_indices(), but takes all scratch memory from the given
+		workspace instead of allocating it.
+
+		@param ws Workspace to use. May be reused for any number of polygons.
+		@param threads Number of threads to triangulate the monotone parts on. 0 uses one thread per
+		hardware thread. Defaults to 1. See fmt::Polygon::triangulate.
+		@return A vector of indices, where each successive three elements indicate the indices of a
+		triangle.
+	*/
+	const std::vector<T_ind>& get_indices(Workspace<T_vert, T_ind>& ws, const unsigned threads = 1);
+
+	/*! Compute a set of indices forming a triangulation of the polygon into a caller-owned buffer.
+
+		Behaves like fmt::Polygon::get_indices, but writes the indices to out instead of the cache of
+		the polygon. If valid cached indices exist, they are copied to out. Incremental polygons
+		always update their cache first.
+
+		@param out Buffer to write the indices to. Must hold at least 3 * triangle_count() elements.
+		@return The number of indices written, where each successive three elements indicate the
+		indices of a triangle.
+	*/
+	T_ind get_indices(T_ind* out);
+
+	/*! Compute a set of indices forming a triangulation of the polygon into a caller-owned buffer.
+
+		Behaves like fmt::Polygon::get_indices(T_ind*), but takes all scratch memory from the given
+		workspace instead of allocating it. Together with a polygon whose vertices are set through
+		set_vertices, this triangulates without any heap allocations once ws has grown large enough.
+
+		@param out Buffer to write the indices to. Must hold at least 3 * triangle_count() elements.
+		@param ws Workspace to use. May be reused for any number of polygons.
+		@param threads Number of threads to triangulate the monotone parts on. 0 uses one thread per
+		hardware thread. Defaults to 1. See fmt::Polygon::triangulate.
+		@return The number of indices written.
+	*/
+	T_ind get_indices(T_ind* out, Workspace<T_vert, T_ind>& ws, const unsigned threads = 1);
+
+	/*! Compute a set of indices forming a triangulation of the polygon and stream them to a sink.
+
+		Behaves like fmt::Polygon::get_indices(T_ind*), but instead of writing all indices to one
+		buffer, it collects the triangles of the monotone parts in a chunk of fixed size and hands
+		every full chunk to sink as soon as it is filled, followed by the last partial chunk. Besides
+		the partition, this takes memory for one chunk only, so that triangulations of huge polygons
+		can be written to a file or a GPU upload ring while they are produced. The indices streamed
+		are the same as those of get_indices. If valid cached indices exist, they are streamed in
+		chunks instead.
+
+		@param sink Callable invoked as sink(const T_ind* indices, T_ind count) for each chunk, where
+		count is a multiple of 3. The indices are only valid during the call.
+		@param chunk Number of indices per chunk, rounded down to a multiple of 3. Defaults to 3072.
+		@throws std::invalid_argument If chunk is less than 3.
+	*/
+	template<class T_sink>
+	void stream_indices(T_sink&& sink, const T_ind chunk = T_ind(3072));
+
+	/*! Compute a set of indices forming a triangulation of the polygon and stream them to a sink.
+
+		Behaves like fmt::Polygon::stream_indices(T_sink&&, const T_ind), but takes all scratch memory,
+		including the chunk, from the given workspace instead of allocating it.
+	*/
+	template<class T_sink>
+	void stream_indices(T_sink&& sink, Workspace<T_vert, T_ind>& ws,
+											const T_ind chunk = T_ind(3072));
+
+	/*! Compute a set of indices forming a triangulation of the polygon into a vector of another
+		index type.
+
+		Behaves like fmt::Polygon::get_indices(), but converts the indices to T_out, e.g. to 16 bit
+		indices for polygons with at most 65536 vertices, which halves the size of an index buffer of
+		32 bit indices. The indices are streamed into out without keeping the T_ind indices.
+
+		@param out Output. Overwritten with the indices, where each successive three elements indicate
+		the indices of a triangle.
+		@throws std::invalid_argument If T_out cannot hold every index of the polygon.
+	*/
+	template<class T_out>
+	void get_indices(std::vector<T_out>& out);
+
+	/*! Compute a set of indices forming a triangulation of the polygon into a vector of another
+		index type.
+
+		Behaves like fmt::Polygon::get_indices(std::vector<T_out>&), but takes all scratch memory from
+		the given workspace instead of allocating it.
+	*/
+	template<class T_out>
+	void get_indices(std::vector<T_out>& out, Workspace<T_vert, T_ind>& ws);
+
+	/*! Compute a triangulation of the polygon as triangle strips.
+
+		Triangle k of a strip is formed by its vertices k, k + 1 and k + 2, and every odd triangle is
+		reversed, so that all triangles are in clockwise orientation as with get_indices. Strips are
+		separated by the largest value of T_out, i.e. null_index for T_ind, to be used as the
+		primitive restart index. The triangles are those of get_indices, which are computed first if
+		they are not valid. Strips are grown greedily across the edges between triangles, also
+		between monotone parts, starting from the triangles with the fewest neighbours. A strip
+		continues through a fan by repeating its hub, at two indices per triangle, and zig-zags at
+		one. Depending on the share of fans, the strips take 0.37-0.63 of the indices of a triangle
+		list. Takes Θ(n) after finding the neighbours of the triangles, see get_adjacency. Does not
+		cache the strips.
+
+		@param strips Output. Overwritten with the strips.
+		@throws std::invalid_argument If T_out cannot hold every index of the polygon and the restart
+		index, e.g. for 16 bit indices and more than 65535 vertices.
+	*/
+	template<class T_out>
+	void get_strips(std::vector<T_out>& strips);
+
+	/*! Compute a triangulation of the polygon as triangle strips.
+
+		Behaves like fmt::Polygon::get_strips(std::vector<T_out>&), but takes all scratch memory from
+		the given workspace instead of allocating it.
+	*/
+	template<class T_out>
+	void get_strips(std::vector<T_out>& strips, Workspace<T_vert, T_ind>& ws);
+
+	/*! Compute the neighbours of the triangles of the triangulation of the polygon.
+
+		Refers to the triangles as returned by get_indices, which are computed first if they are not
+		valid. Element 3 * t + i is the triangle sharing the edge from vertex i to vertex (i + 1) % 3
+		of triangle t, or null_index if that edge lies on the boundary of the polygon. Takes Θ(n) to
+		bucket the edges by vertex, plus sorting the edges at each vertex.
+
+		@param adjacency Output. Overwritten with three neighbours per triangle.
+	*/
+	void get_adjacency(std::vector<T_ind>& adjacency);
+
+	/*! Compute the neighbours of the triangles of the triangulation of the polygon.
+
+		Behaves like fmt::Polygon::get_adjacency(std::vector<T_ind>&), but takes all scratch memory
+		from the given workspace instead of allocating it.
+	*/
+	void get_adjacency(std::vector<T_ind>& adjacency, Workspace<T_vert, T_ind>& ws);
+
+	/*! Flip interior edges of the triangulation towards the constrained Delaunay triangulation.
+
+		Monotone triangulation tends to produce slivers. This post-pass computes the triangulation if
+		it is not valid and then flips every interior edge that is illegal, i.e. whose opposite
+		vertices lie inside the circumcircle of the triangle across it, replacing it by the other
+		diagonal of its quadrilateral. The edges of the quadrilateral are queued again, until no
+		illegal edge is left. Edges on the boundary of the polygon, including holes, are never flipped.
+		The indices are modified in place and stay in clockwise orientation.
+
+		Flipping stops after budget flips. The queue of edges left to check is kept in the polygon, so
+		that the next call continues where the last one stopped, trading quality for latency per call.
+		Once the queue is empty, further calls return 0 in Θ(1) until the triangulation changes. The
+		in-circle test is filtered in floating point without an exact fallback, so edges whose four
+		vertices are nearly cocircular are left as they are.
+
+		Since the triangles no longer follow the monotone parts, editing an incremental polygon after
+		any flip partitions it anew.
+
+		@param budget Largest number of edges to flip. Defaults to null_index, i.e. no limit.
+		@return The number of edges flipped. Less than budget once no illegal edge is left.
+	*/
+	T_ind flip_delaunay(const T_ind budget = _::null_index<T_ind>());
+
+	/*! Flip interior edges of the triangulation towards the constrained Delaunay triangulation.
+
+		Behaves like fmt::Polygon::flip_delaunay(const T_ind), but takes all scratch memory from the
+		given workspace instead of allocating it.
+	*/
+	T_ind flip_delaunay(Workspace<T_vert, T_ind>& ws, const T_ind budget = _::null_index<T_ind>());
+
 	/*! Computes diagonals for the current polygon.
 
+		Partitions the polygon into monotone parts, which are kept alongside the diagonals. Subsequent
+		calls to get_indices triangulate these parts without partitioning again, as long as the
+		vertices are not changed.
+
 		@param force If true, diagonals are computed even if the current state is valid. Defaults to
 		false.
 	*/
 	void compute_diagonals(const bool force = false);
 
+	/*! Computes diagonals for the current polygon.
+
+		Behaves like fmt::Polygon::compute_diagonals(const bool), but takes all scratch memory from
+		the given workspace instead of allocating it.
+	*/
+	void compute_diagonals(Workspace<T_vert, T_ind>& ws, const bool force = false);
+
+	/*! Export the current partition of the polygon.
+
+		Computes the diagonals first if they are not valid. The partition can be stored and later be
+		imported into a polygon with the same vertices through import_partition, which skips the
+		partitioning when triangulating.
+
+		@param partition Output. Overwritten with the partition of the polygon.
+	*/
+	void export_partition(Partition<T_ind>& partition);
+
+	/*! Import a partition exported by export_partition.
+
+		Replaces all diagonals of the polygon. The partition must have been exported from a polygon
+		with the same vertices; this is only checked as far as the number of vertices and the range of
+		the indices go.
+
+		@param partition Partition to import.
+		@throws std::invalid_argument If the partition does not fit the number of vertices.
+	*/
+	void import_partition(const Partition<T_ind>& partition);
+
 	/*! Partitions the polygon into monotone parts.
 
 		The polygon must not have any prior diagonals, else the partitioning will lead to unexpected
@@ -162,6 +598,9 @@ public:
 		which require separate partitioning and triangulation for timing or other reasons. In general,
 		it is best to triangulate a polygon by calling its member function fmt::Polygon::get_indices.
 
+		An x-monotone polygon is recognised from its event vertices and kept as a single part without
+		sorting, locating or sweeping anything. Convex polygons are x-monotone.
+
 		@param frac_starts Denominator to guess amount of start vertices for initial array allocation.
 		10 means 1/10th of all vertices are start vertices. Defaults to 8.
 		@param frac_merges Denominator to guess amount of merge vertices for initial array allocation.
@@ -171,32 +610,100 @@ public:
 		@param frac_stops Denominator to guess amounf of stop vertices for initial array allocation. 10
 		means 1/10th of all vertices are stop vertices. Defaults to 10.
 
-		@returns A pointer to a vector containing all monotone parts to be passed to fmt::triangulate.
-		The caller is responsible for memory management of the vector.
+		@param ws Workspace to take all scratch memory from. The workspace is reset first.
+
+		@returns A reference to a vector containing all monotone parts to be passed to
+		fmt::Polygon::triangulate. The vector is owned by ws and remains valid until ws is reused.
 	*/
   // TODO: Base default frac values on actual math
-	std::vector<MonoPart<T_ind>>* partition(T_ind frac_starts = 8, T_ind frac_merges = 10,
-																					T_ind frac_splits = 10, T_ind frac_stops = 8);
+	std::vector<MonoPart<T_ind>>& partition(Workspace<T_vert, T_ind>& ws, T_ind frac_starts = 8,
+																					T_ind frac_merges = 10, T_ind frac_splits = 10,
+																					T_ind frac_stops = 8);
+
+	/*! Partitions the polygon into monotone parts, sweeping vertical slabs of it in parallel.
+
+		Behaves like fmt::Polygon::partition, but cuts the polygon into up to 256 vertical slabs with
+		about slab_events event vertices each. Each slab is swept on its own, adding diagonals to the
+		last vertex of each region as in de Berg et al., "Computational Geometry", chapter 3. Diagonals
+		whose end lies in an earlier slab are added once all slabs are swept, by a pass over the
+		regions crossing the bounds between slabs. The parts are then found by walking the faces
+		formed by the diagonals. This takes Θ(n + e log e) for e event vertices, spread over the
+		threads, and Θ(n + s log s) for s split vertices on the calling thread.
+
+		The diagonals and parts are the same as those of fmt::Polygon::partition: the diagonal of each
+		split and merge vertex runs to the last vertex of its region in either sweep. The parts are
+		put in the order fmt::Polygon::partition creates them, by the start or split vertex creating
+		each, so that the indices do not depend on the number of threads or on slab_events. The
+		status of each slab is kept in a std::set, so unlike fmt::Polygon::partition this allocates
+		while sweeping.
+
+		@param ws Workspace to take all scratch memory from. The workspace is reset first.
+		@param threads Number of threads to use. 0 uses one thread per hardware thread. Defaults to 0.
+		Ignored if FMT_NO_THREADS is defined.
+		@param slab_events Number of event vertices per slab. Defaults to 4096.
+
+		@returns A reference to a vector containing all monotone parts to be passed to
+		fmt::Polygon::triangulate. The vector is owned by ws and remains valid until ws is reused.
+	*/
+	std::vector<MonoPart<T_ind>>& partition_slabs(Workspace<T_vert, T_ind>& ws, unsigned threads = 0,
+																								const T_ind slab_events = T_ind(4096));
 
 	/*! Take a vector of monotone parts and triangulate them into a set of indices.
 
-		@param parts Pointer to a vector of monotone parts as given by Polygon::partition
+		@param parts Vector of monotone parts as given by Polygon::partition
+		@param ws Workspace to take all scratch memory from.
+		@param threads Number of threads to use. See below.
+	 */
+	void triangulate(const std::vector<MonoPart<T_ind>>& parts, Workspace<T_vert, T_ind>& ws,
+									 const unsigned threads = 1);
+
+	/*! Take a vector of monotone parts and triangulate them into a caller-owned buffer.
+
+		The monotone parts are independent of each other. With more than one thread, the number of
+		triangles of every part is counted first, which determines the range of out that each part is
+		written to. The parts are then triangulated in parallel. This pays off for polygons with many
+		large monotone parts; for small polygons, a single thread is faster. The indices written are
+		identical to those of a single-threaded run.
+
+		@param parts Vector of monotone parts as given by Polygon::partition
+		@param out Buffer to write the indices to. Must hold at least 3 * triangle_count() elements.
+		@param ws Workspace to take all scratch memory from.
+		@param threads Number of threads to use. 0 uses one thread per hardware thread. Defaults to 1.
+		Ignored if FMT_NO_THREADS is defined.
+		@return The number of indices written.
+	 */
+	T_ind triangulate(const std::vector<MonoPart<T_ind>>& parts, T_ind* out,
+										Workspace<T_vert, T_ind>& ws, unsigned threads = 1) const;
+
+	/*! Take a vector of monotone parts and triangulate them into a sink, chunk by chunk.
+
+		The parts are triangulated one after the other on the calling thread. See
+		fmt::Polygon::stream_indices for the sink and the chunks.
+
+		@param parts Vector of monotone parts as given by Polygon::partition
+		@param sink Callable invoked as sink(const T_ind* indices, T_ind count) for each chunk.
+		@param ws Workspace to take all scratch memory from.
+		@param chunk Number of indices per chunk, rounded down to a multiple of 3. Defaults to 3072.
+		@throws std::invalid_argument If chunk is less than 3.
 	 */
-	void triangulate(std::vector<MonoPart<T_ind>>* parts);
+	template<class T_sink>
+	void triangulate_stream(const std::vector<MonoPart<T_ind>>& parts, T_sink&& sink,
+													Workspace<T_vert, T_ind>& ws, const T_ind chunk = T_ind(3072)) const;
 
 	// friend std::vector<fmt::MonoPart<T_ind>>* partition(Polygon& poly, T_ind frac_starts, T_ind
 	// frac_splits);
-
-	//! Destroy the polygon
-	~Polygon();
 };
 } // namespace fmt
 
 // Include implementation files
 #include "polygon.ipp"
-#include "bst.ipp"
+#include "eytzinger.ipp"
 #include "rb_interval.ipp"
 #include "partition.ipp"
+#include "slabs.ipp"
 #include "triangulate.ipp"
+#include "incremental.ipp"
+#include "formats.ipp"
+#include "delaunay.ipp"
 
 #endif // end include guard
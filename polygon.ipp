@@ -4,6 +4,8 @@
 #include "partition.hpp"
 #include "polygon.hpp"
 
+#include <algorithm>
+
 #ifndef FMT_NOEXCEPT
 #	include <stdexcept>
 #endif
@@ -13,6 +15,70 @@ fmt::Polygon<T_vert, T_ind>::Polygon(const std::vector<T_vert>& vec) {
 	set_vertices(vec);
 }
 
+template<class T_vert, class T_ind>
+fmt::Polygon<T_vert, T_ind>::Polygon(const std::vector<T_vert>& vec, const std::vector<T_ind>& holes) {
+	set_vertices(vec, holes);
+}
+
+template<class T_vert, class T_ind>
+fmt::Polygon<T_vert, T_ind>::Polygon(const T_vert* xy, const T_ind count, const T_ind stride) {
+	set_vertices(xy, count, stride);
+}
+
+template<class T_vert, class T_ind>
+fmt::Polygon<T_vert, T_ind>::Polygon(const T_vert* x, const T_vert* y, const T_ind count,
+																		 const T_ind stride) {
+	set_vertices(x, y, count, stride);
+}
+
+template<class T_vert, class T_ind>
+fmt::Polygon<T_vert, T_ind>::Polygon(const Polygon& other)
+		: xs(other.xs), ys(other.ys), x_data(other.x_data), y_data(other.y_data),
+			stride(other.stride), n_verts(other.n_verts), is_view(other.is_view),
+			ring_offsets(other.ring_offsets), nexts(other.nexts), prevs(other.prevs), has_diagonals(other.has_diagonals),
+			has_valid_diagonals(other.has_valid_diagonals), has_valid_indices(other.has_valid_indices),
+			indices(other.indices), parts(other.parts), is_incremental(other.is_incremental),
+			has_valid_part_map(other.has_valid_part_map), part_offsets(other.part_offsets),
+			vertex_parts(other.vertex_parts), edits(other.edits), has_valid_flips(other.has_valid_flips),
+			twins(other.twins), flip_queue(other.flip_queue), queued(other.queued),
+			partition_threads(other.partition_threads) {
+	if (!is_view) bind_owned();
+}
+
+template<class T_vert, class T_ind>
+fmt::Polygon<T_vert, T_ind>& fmt::Polygon<T_vert, T_ind>::operator=(const Polygon& other) {
+	xs = other.xs;
+	ys = other.ys;
+	x_data = other.x_data;
+	y_data = other.y_data;
+	stride = other.stride;
+	n_verts = other.n_verts;
+	is_view = other.is_view;
+	ring_offsets = other.ring_offsets;
+	nexts = other.nexts;
+	prevs = other.prevs;
+	has_diagonals = other.has_diagonals;
+	has_valid_diagonals = other.has_valid_diagonals;
+	has_valid_indices = other.has_valid_indices;
+	indices = other.indices;
+	// MonoPart is not assignable, so the parts are copied element by element
+	parts.clear();
+	for (auto&& it = other.parts.cbegin(); it != other.parts.cend(); ++it)
+		parts.push_back(*it);
+	is_incremental = other.is_incremental;
+	has_valid_part_map = other.has_valid_part_map;
+	part_offsets = other.part_offsets;
+	vertex_parts = other.vertex_parts;
+	edits = other.edits;
+	has_valid_flips = other.has_valid_flips;
+	twins = other.twins;
+	flip_queue = other.flip_queue;
+	queued = other.queued;
+	partition_threads = other.partition_threads;
+	if (!is_view) bind_owned();
+	return *this;
+}
+
 template<class T_vert, class T_ind>
 void fmt::Polygon<T_vert, T_ind>::set_vertices(const std::vector<T_vert>& vec) {
 #ifndef FMT_NOEXCEPT
@@ -25,86 +91,354 @@ void fmt::Polygon<T_vert, T_ind>::set_vertices(const std::vector<T_vert>& vec) {
 
 	invalidate();
 
-	// Resize poly vector, cache original size
-	T_ind existing_size = poly.size();
-	poly.resize(vec.size() / 2);
-	bool is_greater = existing_size < poly.size();
+	// Resize coordinate arrays. Existing storage is reused if the polygon shrinks or stays equal.
+	const T_ind n = vec.size() / 2;
+	xs.resize(n);
+	ys.resize(n);
 
 #ifdef DEBUG
-	std::cout << "Existing size: " << existing_size << "; Current size: " << poly.size()
-						<< "; Is greater: " << is_greater << std::endl;
+	std::cout << "Current size: " << n << std::endl;
 #endif
 
-	// Update element zero if it exists, else create it
-	if (existing_size)
-		poly[0]->set(vec[0], vec[1]);
-	else
-		poly[0] = new Vertex(vec[0], vec[1]);
+	// De-interleave coordinates into the coordinate arrays
+	for (T_ind i = T_ind(0); i < n; ++i) {
+		xs[i] = vec[2 * i];
+		ys[i] = vec[2 * i + 1];
+	}
 
-	// Update all existing elements
-	for (T_ind i = T_ind(2); i < 2 * (is_greater ? existing_size : poly.size()); i += 2)
-		poly[i / 2]->set(vec[i], vec[i + 1], poly[(i / 2) - 1]);
+	bind_owned();
+	ring_offsets.assign(2, T_ind(0));
+	ring_offsets.back() = n;
+	reset_links();
+}
 
-	// Create new elements
-	if (is_greater)
-		for (T_ind i = (existing_size ? existing_size * 2 : 2); i < vec.size(); i += 2)
-			poly[i / 2] = new Vertex(vec[i], vec[i + 1], poly[(i / 2) - 1]);
+template<class T_vert, class T_ind>
+void fmt::Polygon<T_vert, T_ind>::set_vertices(const T_vert* xy, const T_ind count,
+																							 const T_ind stride) {
+	set_vertices(xy, xy + 1, count, stride);
+}
 
-	// Link begin and end
-	poly[0]->prev = poly.back();
-	poly.back()->next = poly[0];
+template<class T_vert, class T_ind>
+void fmt::Polygon<T_vert, T_ind>::set_vertices(const T_vert* x, const T_vert* y, const T_ind count,
+																							 const T_ind stride) {
+#ifndef FMT_NOEXCEPT
+	if (count < 3) throw std::invalid_argument("Cannot create polygon with less than three vertices.");
+#endif
+
+	invalidate();
+
+	x_data = x;
+	y_data = y;
+	this->stride = stride;
+	n_verts = count;
+	is_view = true;
+	ring_offsets.assign(2, T_ind(0));
+	ring_offsets.back() = count;
+
+	reset_links();
+}
+
+template<class T_vert, class T_ind>
+void fmt::Polygon<T_vert, T_ind>::set_vertices(const std::vector<T_vert>& vec,
+																							 const std::vector<T_ind>& holes) {
+	set_vertices(vec);
+	set_holes(holes);
+}
+
+template<class T_vert, class T_ind>
+void fmt::Polygon<T_vert, T_ind>::set_holes(const std::vector<T_ind>& holes) {
+#ifndef FMT_NOEXCEPT
+	T_ind ring_start = T_ind(0);
+	for (auto&& it = holes.cbegin(); it != holes.cend(); ring_start = *(it++))
+		if (*it < ring_start + T_ind(3))
+			throw std::invalid_argument("Cannot create ring with less than three vertices.");
+	if (n_verts < ring_start + T_ind(3))
+		throw std::invalid_argument("Cannot create ring with less than three vertices.");
+#endif
+
+	invalidate();
+
+	ring_offsets.resize(holes.size() + 2);
+	ring_offsets.front() = T_ind(0);
+	std::copy(holes.cbegin(), holes.cend(), ring_offsets.begin() + 1);
+	ring_offsets.back() = n_verts;
+
+	clear_diagonals();
+}
+
+template<class T_vert, class T_ind>
+void fmt::Polygon<T_vert, T_ind>::reset_links() {
+	nexts.resize(n_verts);
+	prevs.resize(n_verts);
+	clear_diagonals();
 }
 
 template<class T_vert, class T_ind>
 void fmt::Polygon<T_vert, T_ind>::add_diagonal(const T_ind from, const T_ind to) {
-	poly[to]->prev = poly[from];
-	poly[from]->next = poly[to];
+	prevs[to] = from;
+	nexts[from] = to;
 	has_diagonals = true;
 }
 
 template<class T_vert, class T_ind>
 void fmt::Polygon<T_vert, T_ind>::clear_diagonals() {
-	for (T_ind i = T_ind(1); i < poly.size(); ++i) {
-		poly[i]->prev = poly[i - 1];
-		poly[i - 1]->next = poly[i];
-	}
+	// Link the vertices of each ring in order and close the ring
+	for (auto&& it = ring_offsets.cbegin(); it + 1 != ring_offsets.cend(); ++it) {
+		const T_ind first = *it, last = *(it + 1) - 1;
+		for (T_ind i = first + 1; i <= last; ++i) {
+			prevs[i] = i - 1;
+			nexts[i - 1] = i;
+		}
 
-	poly[0]->prev = poly[poly.size() - 1];
-	poly[poly.size() - 1]->next = poly[0];
+		prevs[first] = last;
+		nexts[last] = first;
+	}
 
 	has_diagonals = false;
+	has_valid_diagonals = false;
+	has_valid_part_map = false;
 }
 
 template<class T_vert, class T_ind>
-void fmt::Polygon<T_vert, T_ind>::push_back(Vertex* v) {
-	invalidate();
+T_ind fmt::Polygon<T_vert, T_ind>::ring_next(const T_ind i) const {
+	auto&& it = std::upper_bound(ring_offsets.cbegin(), ring_offsets.cend(), i);
+	return i + 1 == *it ? *(it - 1) : i + 1;
+}
+
+template<class T_vert, class T_ind>
+T_ind fmt::Polygon<T_vert, T_ind>::ring_prev(const T_ind i) const {
+	auto&& it = std::upper_bound(ring_offsets.cbegin(), ring_offsets.cend(), i);
+	return i == *(it - 1) ? *it - 1 : i - 1;
+}
+
+template<class T_vert, class T_ind>
+void fmt::Polygon<T_vert, T_ind>::take_ownership() {
+	if (!is_view) return;
+
+	xs.resize(n_verts);
+	ys.resize(n_verts);
+	for (T_ind i = T_ind(0); i < n_verts; ++i) {
+		xs[i] = this->x(i);
+		ys[i] = this->y(i);
+	}
+	bind_owned();
+}
+
+template<class T_vert, class T_ind>
+void fmt::Polygon<T_vert, T_ind>::push_back(const T_vert x, const T_vert y) {
+	const T_ind first = *(ring_offsets.end() - 2), last = size() - 1; // of the last ring
+
+	// An incremental polygon keeps its parts if the edge the vertex is inserted into is no diagonal.
+	// The vertex then joins the part of that edge.
+	T_ind part = _::null_index<T_ind>();
+	if (has_valid_part_map && nexts[last] == first && prevs[first] == last)
+		part = vertex_parts[last] != _::null_index<T_ind>() ? vertex_parts[last] : vertex_parts[first];
+
+	if (part == _::null_index<T_ind>()) {
+		invalidate();
+		if (has_diagonals) clear_diagonals();
+	}
 
-	v->prev = poly.back();
-	poly.back()->next = v;
+	// Take ownership of the coordinates of a view before modifying them
+	take_ownership();
 
-	poly.push_back(v);
+	xs.push_back(x);
+	ys.push_back(y);
+	bind_owned();
 
-	v->next = poly[0];
-	poly[0]->next = v;
+	// Link the new vertex between the previous last and the first vertex of the last ring
+	const T_ind vert = size() - 1;
+	ring_offsets.back() = size();
+	nexts.push_back(first);
+	prevs.push_back(last);
+	nexts[last] = vert;
+	prevs[first] = vert;
+
+	if (part != _::null_index<T_ind>()) {
+		// The part keeps the vertices following its head, which may now be the new vertex
+		MonoPart<T_ind>& mono = parts[part];
+		if (mono.head == last && mono.first_upper == first) mono.first_upper = vert;
+		if (mono.head == first && mono.first_lower == last) mono.first_lower = vert;
+
+		// Make room for the additional triangle of the part
+		indices.insert(indices.begin() + part_offsets[part + 1], 3, T_ind(0));
+		for (auto&& it = part_offsets.begin() + part + 1; it != part_offsets.end(); ++it)
+			*it += T_ind(3);
+
+		vertex_parts.push_back(part);
+		edits.push_back(vert);
+		has_valid_indices = false;
+	}
+}
+
+template<class T_vert, class T_ind>
+void fmt::Polygon<T_vert, T_ind>::set_vertex(const T_ind i, const T_vert x, const T_vert y) {
+	take_ownership();
+	xs[i] = x;
+	ys[i] = y;
+
+	if (has_valid_part_map) {
+		edits.push_back(i);
+		has_valid_indices = false;
+	} else
+		invalidate();
+}
+
+template<class T_vert, class T_ind>
+void fmt::Polygon<T_vert, T_ind>::set_incremental(const bool incremental) {
+	is_incremental = incremental;
+	if (!incremental) {
+		has_valid_part_map = false;
+		edits.clear();
+	}
 }
 
 template<class T_vert, class T_ind>
 const std::vector<T_ind>& fmt::Polygon<T_vert, T_ind>::get_indices() {
 	if (has_valid_indices) return indices;
-	// TODO: Support using cached diagonals
-	if (has_diagonals) clear_diagonals();
-	std::vector<MonoPart<T_ind>>* parts = partition();
-	triangulate(parts);
-	delete parts;
+	Workspace<T_vert, T_ind> ws;
+	return get_indices(ws);
+}
+
+template<class T_vert, class T_ind>
+const std::vector<T_ind>& fmt::Polygon<T_vert, T_ind>::get_indices(Workspace<T_vert, T_ind>& ws,
+																																		 const unsigned threads) {
+	if (has_valid_indices) return indices;
+	if (has_valid_part_map) {
+		if (update_parts(ws)) return indices;
+		has_valid_diagonals = false; // an edit broke its part
+	}
+
+	compute_diagonals(ws);
+	triangulate(parts, ws, threads);
+	if (is_incremental) map_parts();
 	return indices;
 }
 
 template<class T_vert, class T_ind>
-fmt::Polygon<T_vert, T_ind>::~Polygon() {
-	// Delete all vertices
-	for (auto it = poly.begin(); it != poly.end(); ++it)
-		delete *it;
-	// Invalidate pointers stored in the vector
-	poly.clear();
+T_ind fmt::Polygon<T_vert, T_ind>::get_indices(T_ind* out) {
+	if (has_valid_indices) {
+		std::copy(indices.cbegin(), indices.cend(), out);
+		return indices.size();
+	}
+	Workspace<T_vert, T_ind> ws;
+	return get_indices(out, ws);
+}
+
+template<class T_vert, class T_ind>
+T_ind fmt::Polygon<T_vert, T_ind>::get_indices(T_ind* out, Workspace<T_vert, T_ind>& ws,
+																							 const unsigned threads) {
+	if (has_valid_indices || is_incremental) {
+		const std::vector<T_ind>& cached = get_indices(ws, threads);
+		std::copy(cached.cbegin(), cached.cend(), out);
+		return cached.size();
+	}
+	compute_diagonals(ws);
+	return triangulate(parts, out, ws, threads);
+}
+
+template<class T_vert, class T_ind>
+template<class T_sink>
+void fmt::Polygon<T_vert, T_ind>::stream_indices(T_sink&& sink, const T_ind chunk) {
+	Workspace<T_vert, T_ind> ws;
+	stream_indices(sink, ws, chunk);
+}
+
+template<class T_vert, class T_ind>
+template<class T_sink>
+void fmt::Polygon<T_vert, T_ind>::stream_indices(T_sink&& sink, Workspace<T_vert, T_ind>& ws,
+																								 const T_ind chunk) {
+	if (has_valid_indices || is_incremental) {
+#ifndef FMT_NOEXCEPT
+		if (chunk < T_ind(3)) throw std::invalid_argument("Chunks must hold at least one triangle.");
+#endif
+		const std::vector<T_ind>& cached = get_indices(ws);
+		const T_ind step = chunk - chunk % T_ind(3);
+		for (T_ind i = T_ind(0); i < cached.size(); i += step)
+			sink(cached.data() + i, std::min(step, T_ind(cached.size() - i)));
+		return;
+	}
+	compute_diagonals(ws);
+	triangulate_stream(parts, sink, ws, chunk);
+}
+
+template<class T_vert, class T_ind>
+void fmt::Polygon<T_vert, T_ind>::compute_diagonals(const bool force) {
+	if (has_valid_diagonals && !force) return;
+	Workspace<T_vert, T_ind> ws;
+	compute_diagonals(ws, force);
+}
+
+template<class T_vert, class T_ind>
+void fmt::Polygon<T_vert, T_ind>::compute_diagonals(Workspace<T_vert, T_ind>& ws, const bool force) {
+	if (has_valid_diagonals && !force) return;
+	if (has_diagonals) clear_diagonals();
+	// both keep the parts in the polygon
+	if (partition_threads != 1)
+		partition_slabs(ws, partition_threads);
+	else
+		partition(ws);
+}
+
+template<class T_vert, class T_ind>
+void fmt::Polygon<T_vert, T_ind>::export_partition(Partition<T_ind>& partition) {
+	compute_diagonals();
+
+	partition.size = n_verts;
+	partition.links.clear();
+	partition.heads.clear();
+	partition.tails.clear();
+	partition.uppers.clear();
+	partition.lowers.clear();
+
+	for (T_ind i = T_ind(0); i < n_verts; ++i) {
+		if (nexts[i] == ring_next(i) && prevs[i] == ring_prev(i)) continue;
+
+		partition.links.push_back(i);
+		partition.links.push_back(nexts[i]);
+		partition.links.push_back(prevs[i]);
+	}
+
+	for (auto&& it = parts.cbegin(); it != parts.cend(); ++it) {
+		partition.heads.push_back(it->head);
+		partition.tails.push_back(it->tail);
+		partition.uppers.push_back(it->first_upper);
+		partition.lowers.push_back(it->first_lower);
+	}
+}
+
+template<class T_vert, class T_ind>
+void fmt::Polygon<T_vert, T_ind>::import_partition(const Partition<T_ind>& partition) {
+#ifndef FMT_NOEXCEPT
+	if (partition.size != n_verts || partition.links.size() % 3 ||
+			partition.heads.size() != partition.tails.size() ||
+			partition.heads.size() != partition.uppers.size() ||
+			partition.heads.size() != partition.lowers.size())
+		throw std::invalid_argument("Partition is malformed or does not fit the polygon.");
+	for (auto&& it = partition.links.cbegin(); it != partition.links.cend(); ++it)
+		if (*it >= n_verts) throw std::invalid_argument("Partition links vertices out of range.");
+	for (T_ind i = T_ind(0); i < partition.heads.size(); ++i)
+		if (partition.heads[i] >= n_verts || partition.tails[i] >= n_verts ||
+				partition.uppers[i] >= n_verts || partition.lowers[i] >= n_verts)
+			throw std::invalid_argument("Partition has parts out of range.");
+#endif
+
+	invalidate();
+	clear_diagonals();
+
+	for (auto&& it = partition.links.cbegin(); it != partition.links.cend(); it += 3) {
+		nexts[*it] = *(it + 1);
+		prevs[*it] = *(it + 2);
+	}
+	has_diagonals = !partition.links.empty();
+
+	// Events are not part of the partition; the parts are only ever triangulated
+	parts.clear();
+	for (T_ind i = T_ind(0); i < partition.heads.size(); ++i) {
+		parts.emplace_back(partition.heads[i], partition.uppers[i], partition.lowers[i],
+											 _::null_index<T_ind>(), _::null_index<T_ind>());
+		parts.back().tail = partition.tails[i];
+	}
+	has_valid_diagonals = true;
 }
 #endif
@@ -0,0 +1,193 @@
+#ifndef FMT_PREDICATES_H
+#define FMT_PREDICATES_H
+
+/* Defines the geometric predicates of the sweeps, exact for all finite coordinates */
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+namespace fmt {
+namespace _ {
+
+/*! Arithmetic of a coordinate type. Not meant for external use.
+
+	Floating-point coordinates are used as they are. Integral coordinates, such as int32 tile
+	coordinates or fixed-point coordinates stored as integers, are interpolated in double. Their
+	cross products are evaluated exactly in an integer of twice their width, where one exists.
+*/
+template<class T_vert, class = void>
+struct Coord {
+	typedef T_vert Real; //!< Type of coordinates interpolated along edges
+	static constexpr bool is_wide = false;
+
+	//! A coordinate which every finite coordinate is swept before
+	static T_vert beyond() { return std::numeric_limits<T_vert>::infinity(); }
+};
+
+template<class T_vert>
+struct Coord<T_vert, typename std::enable_if<std::is_integral<T_vert>::value>::type> {
+	typedef double Real;
+#if defined(__SIZEOF_INT128__)
+	static constexpr bool is_wide = sizeof(T_vert) <= 4;
+	__extension__ typedef typename std::conditional<sizeof(T_vert) <= 2, int64_t, __int128>::type Wide;
+#else
+	static constexpr bool is_wide = sizeof(T_vert) <= 2;
+	typedef int64_t Wide;
+#endif
+
+	//! The largest coordinate. Ties with it are broken by index, and null_index comes last.
+	static T_vert beyond() { return std::numeric_limits<T_vert>::max(); }
+};
+
+/*! Exact floating-point arithmetic on expansions, i.e. sums of non-overlapping components.
+	Not meant for external use.
+
+	Each operation returns its rounded result and the rounding error, which is exactly
+	representable, see Shewchuk, "Adaptive Precision Floating-Point Arithmetic and Fast Robust
+	Geometric Predicates". Requires round-to-nearest arithmetic without extended intermediate
+	precision, so do not build with -ffast-math or x87 floating point.
+*/
+template<class T>
+struct Expansion {
+	static void two_sum(const T a, const T b, T& sum, T& err) {
+		sum = a + b;
+		const T b_virt = sum - a, a_virt = sum - b_virt;
+		err = (a - a_virt) + (b - b_virt);
+	}
+
+	static void two_diff(const T a, const T b, T& diff, T& err) {
+		diff = a - b;
+		const T b_virt = a - diff, a_virt = diff + b_virt;
+		err = (a - a_virt) + (b_virt - b);
+	}
+
+	static void two_product(const T a, const T b, T& product, T& err) {
+		product = a * b;
+		err = std::fma(a, b, -product);
+	}
+
+	//! Add a value to an expansion of components in increasing magnitude, dropping zeros
+	static void grow(T* components, unsigned& count, const T value) {
+		T sum = value;
+		unsigned kept = 0;
+		for (unsigned i = 0; i < count; ++i) {
+			T err;
+			two_sum(sum, components[i], sum, err);
+			if (err != T(0)) components[kept++] = err;
+		}
+		if (sum != T(0)) components[kept++] = sum;
+		count = kept;
+	}
+};
+
+/*! Sign of (x2 - x1) * (y3 - y1) - (y2 - y1) * (x3 - x1), computed exactly.
+
+	The determinant is evaluated in floating point first. Only if it is smaller than its error bound
+	is it evaluated again exactly, which takes around 60 additional operations. Integral coordinates
+	of up to 32 bits are evaluated in an integer of twice their width instead, see _::Coord; wider
+	ones in double, which is exact up to 2^53.
+
+	@returns 1 if the points are in counter-clockwise order in y-up coordinates, -1 if clockwise
+	and 0 if they are collinear.
+*/
+template<class T_vert>
+inline typename std::enable_if<Coord<T_vert>::is_wide, int>::type
+		orientation(const T_vert x1, const T_vert y1, const T_vert x2, const T_vert y2, const T_vert x3,
+								const T_vert y3) {
+	typedef typename Coord<T_vert>::Wide W;
+	const W det = (W(x2) - W(x1)) * (W(y3) - W(y1)) - (W(y2) - W(y1)) * (W(x3) - W(x1));
+	return int(det > W(0)) - int(det < W(0));
+}
+
+template<class T_vert>
+inline typename std::enable_if<!Coord<T_vert>::is_wide, int>::type
+		orientation(const T_vert x1, const T_vert y1, const T_vert x2, const T_vert y2, const T_vert x3,
+								const T_vert y3) {
+	typedef typename std::conditional<std::is_floating_point<T_vert>::value, T_vert, double>::type T;
+	typedef Expansion<T> E;
+
+	const T left = (T(x2) - T(x1)) * (T(y3) - T(y1));
+	const T right = (T(y2) - T(y1)) * (T(x3) - T(x1));
+	const T det = left - right;
+
+	// Error bound of the evaluation above for unit roundoff u, see Shewchuk
+	const T u = std::numeric_limits<T>::epsilon() / T(2);
+	const T bound = (T(3) + T(16) * u) * u * (std::abs(left) + std::abs(right));
+	if (det > bound) return 1;
+	if (-det > bound) return -1;
+
+	// Expand the differences into two exact components each, and sum all 8 partial products
+	T dx2[2], dy3[2], dy2[2], dx3[2];
+	E::two_diff(T(x2), T(x1), dx2[1], dx2[0]);
+	E::two_diff(T(y3), T(y1), dy3[1], dy3[0]);
+	E::two_diff(T(y2), T(y1), dy2[1], dy2[0]);
+	E::two_diff(T(x3), T(x1), dx3[1], dx3[0]);
+
+	T components[16];
+	unsigned count = 0;
+	for (unsigned i = 0; i < 2; ++i)
+		for (unsigned j = 0; j < 2; ++j) {
+			T product, err;
+			E::two_product(dx2[i], dy3[j], product, err);
+			E::grow(components, count, err);
+			E::grow(components, count, product);
+			E::two_product(-dy2[i], dx3[j], product, err);
+			E::grow(components, count, err);
+			E::grow(components, count, product);
+		}
+
+	// The largest component decides the sign
+	if (!count) return 0;
+	return components[count - 1] > T(0) ? 1 : -1;
+}
+
+/*! Sign of the in-circle determinant of d with respect to the circle through a, b and c.
+
+	Evaluated in floating point with the error bound of Shewchuk, "Adaptive Precision Floating-Point
+	Arithmetic and Fast Robust Geometric Predicates". Unlike _::orientation, there is no exact
+	fallback: determinants within the bound are reported as 0, i.e. as if d was on the circle.
+	Integral coordinates are evaluated in double.
+
+	@returns 1 if d lies inside the circle and a, b and c are in counter-clockwise order in y-up
+	coordinates, -1 if it lies outside, and the opposite for clockwise order. 0 if undecided.
+*/
+template<class T_vert>
+inline int incircle(const T_vert ax, const T_vert ay, const T_vert bx, const T_vert by,
+										const T_vert cx, const T_vert cy, const T_vert dx, const T_vert dy) {
+	typedef typename std::conditional<std::is_floating_point<T_vert>::value, T_vert, double>::type T;
+
+	const T adx = T(ax) - T(dx), ady = T(ay) - T(dy);
+	const T bdx = T(bx) - T(dx), bdy = T(by) - T(dy);
+	const T cdx = T(cx) - T(dx), cdy = T(cy) - T(dy);
+
+	const T bc = bdx * cdy - cdx * bdy, ca = cdx * ady - adx * cdy, ab = adx * bdy - bdx * ady;
+	const T a_lift = adx * adx + ady * ady, b_lift = bdx * bdx + bdy * bdy,
+					c_lift = cdx * cdx + cdy * cdy;
+	const T det = a_lift * bc + b_lift * ca + c_lift * ab;
+
+	const T permanent = (std::abs(bdx * cdy) + std::abs(cdx * bdy)) * a_lift +
+											(std::abs(cdx * ady) + std::abs(adx * cdy)) * b_lift +
+											(std::abs(adx * bdy) + std::abs(bdx * ady)) * c_lift;
+	const T u = std::numeric_limits<T>::epsilon() / T(2);
+	const T bound = (T(10) + T(96) * u) * u * permanent;
+	if (det > bound) return 1;
+	if (-det > bound) return -1;
+	return 0;
+}
+
+/*! Sweep order of two vertices with symbolic perturbation: by x, then by y, then by index.
+
+	Breaking ties in x by y acts like a sweep line rotated by an infinitesimal angle, and ties in
+	both by index like moving each vertex by a distinct infinitesimal amount, so that even
+	duplicate vertices are swept one at a time in a fixed order.
+*/
+template<class T_vert, class T_ind>
+constexpr inline bool is_before(const T_vert x1, const T_vert y1, const T_ind i1, const T_vert x2,
+																const T_vert y2, const T_ind i2) {
+	return x1 < x2 || (x1 == x2 && (y1 < y2 || (y1 == y2 && i1 < i2)));
+}
+} // namespace _
+} // namespace fmt
+#endif
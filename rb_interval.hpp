@@ -7,72 +7,78 @@
  *
  * All intervals are assumed to be non-overlapping, hence this is not a true
  * interval tree but rather a more specific implementation for this algorithm.
+ *
+ * Nodes are allocated from a node pool owned by the caller and link each other by 32-bit indices
+ * into the pool, so that the pool may grow freely and is reused across calls without allocating.
+ * Index 0 is a black sentinel standing in for all leaves.
+ *
+ * Nodes store no keys. Every operation takes a function computing the key of the data of a node
+ * at the time of the call, so that keys may change between calls as long as their order does not.
  */
 
+#include "instrument.hpp"
+
+#include <cstdint>
+#include <vector>
+
 namespace fmt {
 namespace _ {
+//! Index of a node in the node pool of an RB_Interval. 0 refers to no node.
+typedef uint32_t RB_Link;
+
 //! Not meant to be used externally
 template<class T_key, class T_data, class T_ind>
 class RB_Interval {
 public:
+	typedef RB_Link Link;
 	struct Node; // forward-declaration
 private:
-	Node* _root = nullptr;
+	Link _root = 0;
 	T_ind _size = 0;
 
+	std::vector<Node>& nodes;      //!< Node pool, nodes[0] is the sentinel
+	std::vector<Link>& free_nodes; //!< Removed nodes in the pool, to be reused by insert
+	Stats& stats;                  //!< Counts the operations on the tree, see fmt::Stats
+
 	// Rotation direction for the rotate method
 	enum RDir : bool { LEFT = true, RIGHT = false };
 
 	// Node color
 	enum Color : bool { RED = true, BLACK = false };
 
-	void rotate(Node* node, const RDir direction);
-	void _clear(Node* node);
+	void rotate(const Link node, const RDir direction);
+	Link allocate(const T_data data, const Link dad);
+	void transplant(const Link node, const Link replacement);
 
 	// Enforce red-black rules
-	void fixup_postinsert(Node* node);
-	void fixup_postdelete(Node* node, Node* replacement);
+	void fixup_postinsert(Link node);
+	void fixup_postdelete(Link node);
 
 public:
 	//! Node is only exposed for efficient handling of deletions from the caller
 	struct Node {
-		T_key key;
-		const T_data data; //! Passed around with copy assignments, should be a pointer!
+		T_data data; //! Passed around with copy assignments, should be an index or a pointer!
+		Link left, right, dad;
 		Color color;
-		Node *left = nullptr, *right = nullptr, *dad;
-
-		Node(T_key key, const T_data data)
-				: key(key), data(data), color(BLACK), dad(nullptr) {} // root constructor
-		Node(T_key key, const T_data data, Node* dad)
-				: key(key), data(data), dad(dad), color(RED) {} // standard constructor
-
-		Node* grandfather() const {
-			if (dad) return dad->dad;
-			return nullptr;
-		}
-		Node* sibling() const {
-			if (!dad) return nullptr;
-			if (dad->left == this) return dad->right;
-			return dad->left;
-		}
-		Node* uncle() const {
-			if (!dad) return nullptr;
-			return dad->sibling();
-		}
 	};
 
-	RB_Interval();
-	~RB_Interval();
+	//! Construct an empty tree on the given node pool. The pool is cleared.
+	RB_Interval(std::vector<Node>& nodes, std::vector<Link>& free_nodes, Stats& stats);
 
 	const T_ind size() const { return _size; }
-	const Node* get_root() const { return _root; }
+	Link get_root() const { return _root; }
 
 	void clear();
 
-	Node* insert(const T_key min, const T_data data);
-	T_data find(const T_key key) const;
+	//! Insert the interval of data starting at min. key_of(data) gives the current lower bound of
+	//! the interval of the data of a node.
+	template<class T_key_of>
+	Link insert(const T_key min, const T_data data, T_key_of&& key_of);
+	//! Find the data of the interval containing key, see insert
+	template<class T_key_of>
+	T_data find(const T_key key, T_key_of&& key_of) const;
 
-	void remove(Node* node);
+	void remove(const Link node);
 };
 } // namespace _
 } // namespace fmt
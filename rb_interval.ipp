@@ -3,254 +3,264 @@
 
 #include "rb_interval.hpp"
 
-#include <cstdint>
-
 namespace fmt {
 
 template<class T_key, class T_data, class T_ind>
-_::RB_Interval<T_key, T_data, T_ind>::RB_Interval() {}
-template<class T_key, class T_data, class T_ind>
-_::RB_Interval<T_key, T_data, T_ind>::~RB_Interval() {
+_::RB_Interval<T_key, T_data, T_ind>::RB_Interval(std::vector<Node>& nodes,
+																									std::vector<Link>& free_nodes,
+																									Stats& stats)
+		: nodes(nodes), free_nodes(free_nodes), stats(stats) {
 	clear();
 }
 
+// Releases all nodes to the pool in Θ(1)
 template<class T_key, class T_data, class T_ind>
 void _::RB_Interval<T_key, T_data, T_ind>::clear() {
-	_clear(_root);
-	_root = nullptr;
+	nodes.resize(1); // keep the sentinel
+	nodes[0].left = nodes[0].right = nodes[0].dad = 0;
+	nodes[0].color = BLACK;
+	free_nodes.clear();
+	_root = 0;
 	_size = 0;
 }
 
+// Take a node from the free list, or append it to the pool
 template<class T_key, class T_data, class T_ind>
-void _::RB_Interval<T_key, T_data, T_ind>::_clear(Node* node) {
-	if (!node) return;
-	_clear(node->left);
-	_clear(node->right);
-	delete node;
+typename _::RB_Interval<T_key, T_data, T_ind>::Link
+		_::RB_Interval<T_key, T_data, T_ind>::allocate(const T_data data, const Link dad) {
+	Link slot;
+	if (free_nodes.empty()) {
+		slot = nodes.size();
+		nodes.emplace_back();
+	} else {
+		slot = free_nodes.back();
+		free_nodes.pop_back();
+	}
+
+	Node& node = nodes[slot];
+	node.data = data;
+	node.left = node.right = 0;
+	node.dad = dad;
+	node.color = RED;
+	return slot;
 }
 
 template<class T_key, class T_data, class T_ind>
-void _::RB_Interval<T_key, T_data, T_ind>::rotate(Node* node, const RDir direction) {
-	Node* tmp_node;
+void _::RB_Interval<T_key, T_data, T_ind>::rotate(const Link node, const RDir direction) {
+	Node& n = nodes[node];
+	Link tmp_node;
 	if (direction == RIGHT) {
-		tmp_node = node->left;
-		node->left = tmp_node->right;
-		if (node->left) node->left->dad = node;
-		tmp_node->right = node;
+		tmp_node = n.left;
+		n.left = nodes[tmp_node].right;
+		if (n.left) nodes[n.left].dad = node;
+		nodes[tmp_node].right = node;
 	} else { // left
-		tmp_node = node->right;
-		node->right = tmp_node->left;
-		if (node->right) node->right->dad = node;
-		tmp_node->left = node;
+		tmp_node = n.right;
+		n.right = nodes[tmp_node].left;
+		if (n.right) nodes[n.right].dad = node;
+		nodes[tmp_node].left = node;
 	}
 
-	if (node->dad)
-		if (node->dad->left == node)
-			node->dad->left = tmp_node;
+	if (n.dad)
+		if (nodes[n.dad].left == node)
+			nodes[n.dad].left = tmp_node;
 		else
-			node->dad->right = tmp_node;
+			nodes[n.dad].right = tmp_node;
 	else
 		_root = tmp_node;
 
-	tmp_node->dad = node->dad;
-	node->dad = tmp_node;
+	nodes[tmp_node].dad = n.dad;
+	n.dad = tmp_node;
 }
 
-// The tree will only be a valid representation of the polygon when all
-// insertions and updates have been processed. Must first call update on all
-// existing entires to prevent key conflicts
+// Keys are computed while descending, so every node on the way must be able to give its current
+// key: nodes whose intervals ended must be removed before inserting
 template<class T_key, class T_data, class T_ind>
-typename _::RB_Interval<T_key, T_data, T_ind>::Node*
-		_::RB_Interval<T_key, T_data, T_ind>::insert(const T_key min, const T_data data) {
+template<class T_key_of>
+typename _::RB_Interval<T_key, T_data, T_ind>::Link
+		_::RB_Interval<T_key, T_data, T_ind>::insert(const T_key min, const T_data data,
+																								 T_key_of&& key_of) {
 	++_size;
-	if (!_root) {
-		_root = new Node(min, data);
-		return _root;
-	}
 
 	// locate min
-	Node* tmp_node = _root;
-	int_fast8_t flag = 0;
-	while (!flag) // location routine
-		if (tmp_node->key > min) {
-			flag = tmp_node->left ? 0 : -1;
-			if (tmp_node->left) tmp_node = tmp_node->left;
-		} else {
-			flag = tmp_node->right ? 0 : 1;
-			if (tmp_node->right) tmp_node = tmp_node->right;
-		}
-	if (flag == -1) { // insert left
-		tmp_node->left = new Node(min, data, tmp_node);
-		fixup_postinsert(tmp_node->left);
-	} else { // insert right
-		tmp_node->right = new Node(min, data, tmp_node);
-		fixup_postinsert(tmp_node->right);
+	Link dad = 0;
+	bool is_left = false;
+	uint64_t depth = 0;
+	for (Link tmp_node = _root; tmp_node; ++depth) { // location routine
+		dad = tmp_node;
+		is_left = key_of(nodes[tmp_node].data) > min;
+		tmp_node = is_left ? nodes[tmp_node].left : nodes[tmp_node].right;
 	}
+	_::count(stats.tree_inserts);
+	_::count_max(stats.tree_depth, depth);
+
+	const Link node = allocate(data, dad);
+	if (!dad)
+		_root = node;
+	else if (is_left)
+		nodes[dad].left = node;
+	else
+		nodes[dad].right = node;
+	fixup_postinsert(node);
+	return node;
 }
 
 template<class T_key, class T_data, class T_ind>
-void _::RB_Interval<T_key, T_data, T_ind>::fixup_postinsert(Node* node) {
-	if (!node->dad) {
-		node->color = BLACK;
-		return;
-	}
-	if (node->dad->color == RED) {
-		Node* grandpa = node->grandfather();
-		Node* uncle = node->uncle();
-		if (uncle && uncle->color == RED) {
-			node->dad->color = BLACK;  // was red by parent if statement
-			uncle->color = BLACK;      // was red (see this if statement)
-			grandpa->color = RED;      // was black by definition
-			fixup_postinsert(grandpa); // recursion
-		} else {                     // uncle is black or dead (or grandpa is dead)
-			if ((node == node->dad->right) && (node->dad == grandpa->left)) { // right left case
-				rotate(node->dad, LEFT);
-				node = node->left;
-			} else if ((node == node->dad->left) && (node->dad == grandpa->right)) { // left right case
-				rotate(node->dad, RIGHT);
-				node = node->right;
-			}
+void _::RB_Interval<T_key, T_data, T_ind>::fixup_postinsert(Link node) {
+	// The root is black, so a red dad always has a dad itself
+	while (nodes[nodes[node].dad].color == RED) {
+		Link dad = nodes[node].dad;
+		const Link grandpa = nodes[dad].dad;
+		const bool dad_is_left = nodes[grandpa].left == dad;
+		const Link uncle = dad_is_left ? nodes[grandpa].right : nodes[grandpa].left;
 
-			node->dad->color = BLACK; // was red (see parent if statement)
-			grandpa->color = RED;     // was black by definition
+		if (nodes[uncle].color == RED) {
+			nodes[dad].color = BLACK;   // was red by loop condition
+			nodes[uncle].color = BLACK; // was red (see this if statement)
+			nodes[grandpa].color = RED; // was black by definition
+			node = grandpa;             // continue upwards
+			continue;
+		}
 
-			if ((node == node->dad->left) && (node->dad == grandpa->left)) // left left case
-				rotate(grandpa, RIGHT);
-			else
-				rotate(grandpa, LEFT);
+		// uncle is black or dead
+		if (dad_is_left && node == nodes[dad].right) { // left right case
+			rotate(dad, LEFT);
+			dad = node;
+		} else if (!dad_is_left && node == nodes[dad].left) { // right left case
+			rotate(dad, RIGHT);
+			dad = node;
 		}
+
+		nodes[dad].color = BLACK;   // was red (see loop condition)
+		nodes[grandpa].color = RED; // was black by definition
+		rotate(grandpa, dad_is_left ? RIGHT : LEFT);
+		break;
 	}
+	nodes[_root].color = BLACK;
+}
+
+// Replace the subtree at node by the one at replacement, which may be the sentinel
+template<class T_key, class T_data, class T_ind>
+void _::RB_Interval<T_key, T_data, T_ind>::transplant(const Link node, const Link replacement) {
+	const Link dad = nodes[node].dad;
+	if (!dad)
+		_root = replacement;
+	else if (nodes[dad].left == node)
+		nodes[dad].left = replacement;
+	else
+		nodes[dad].right = replacement;
+	nodes[replacement].dad = dad; // also set on the sentinel, as fixup_postdelete starts there
 }
 
 // Does not check if node exists!
 template<class T_key, class T_data, class T_ind>
-void _::RB_Interval<T_key, T_data, T_ind>::remove(
-		typename _::RB_Interval<T_key, T_data, T_ind>::Node* node) {
+void _::RB_Interval<T_key, T_data, T_ind>::remove(const Link node) {
 	--_size;
-	Node* replacement;
-	if (!node->left)
-		replacement = node->right; // may be nullptr
-	else if (!node->right)
-		replacement = node->left; // may be nullptr
-	else {
-		// Node has two children; execute recvursive deletion algorithm:
-		// Find inorder successor (could also find predecessor)
-		// Switch node with replacement; delete replacement
-		replacement = node->right;
-		while (replacement->left)
-			replacement = replacement->left;
-
-		// Update references (cannot just copy data since owner of tree has references to nodes)
-		if (replacement->dad->left == replacement)
-			replacement->dad->left = replacement->right; // update dad's reference
-		else
-			replacement->dad->right = replacement->right;                     // update dad's reference
-		if (replacement->right) replacement->right->dad = replacement->dad; // update child's reference
+	_::count(stats.tree_removes);
+	Node& n = nodes[node];
+	Color removed_color = n.color;
+	Link replacement;
 
-		// perform fixup
-		fixup_postdelete(replacement, replacement->right);
+	if (!n.left) {
+		replacement = n.right; // may be the sentinel
+		transplant(node, replacement);
+	} else if (!n.right) {
+		replacement = n.left;
+		transplant(node, replacement);
+	} else {
+		// Node has two children: move its inorder successor into its place. Nodes are referenced by
+		// the owner of the tree, so links are updated instead of swapping data.
+		Link successor = n.right;
+		while (nodes[successor].left)
+			successor = nodes[successor].left;
 
-		// update replacement's references to move to node's position
-		replacement->dad = node->dad;
-		replacement->left = node->left;
-		replacement->right = node->right;
-		// update node's dad's reference to child
-		if (node->dad->left == node)
-			node->dad->left = replacement;
-		else
-			node->dad->right = replacement;
-		// update node's children to new dad. Note that replacement's children have changed.
-		if (replacement->left) replacement->left->dad = replacement;
-		if (replacement->right) replacement->right->dad = replacement;
-		// Everything is (should be) updated properly. Now delete node.
-		delete node;
-		return;
-	}
+		removed_color = nodes[successor].color;
+		replacement = nodes[successor].right;
+		if (nodes[successor].dad == node)
+			nodes[replacement].dad = successor;
+		else {
+			transplant(successor, replacement);
+			nodes[successor].right = n.right;
+			nodes[n.right].dad = successor;
+		}
 
-	if (node->dad) { // node is not root
-		// update dad's reference to child
-		if (node->dad->left == node)
-			node->dad->left = replacement;
-		else
-			node->dad->right = replacement;
-		if (replacement) replacement->dad = node->dad; // update child's reference to dad
-	} else {                                         // node is root
-		_root = replacement;
-		if (replacement) replacement->dad = nullptr;
+		transplant(node, successor);
+		nodes[successor].left = n.left;
+		nodes[n.left].dad = successor;
+		nodes[successor].color = n.color;
 	}
 
-	fixup_postdelete(node, replacement);
-	delete node;
+	if (removed_color == BLACK) fixup_postdelete(replacement);
+	free_nodes.push_back(node);
 }
 
+// node carries an extra black, which is pushed upwards until it can be absorbed
 template<class T_key, class T_data, class T_ind>
-void _::RB_Interval<T_key, T_data, T_ind>::fixup_postdelete(Node* node, Node* replacement) {
-	if (node->color || _root == replacement ||
-			(replacement && replacement->color)) { // either is red, simple case
-		if (replacement) replacement->color = BLACK;
-		return;
-	}
+void _::RB_Interval<T_key, T_data, T_ind>::fixup_postdelete(Link node) {
+	while (node != _root && nodes[node].color == BLACK) {
+		const Link dad = nodes[node].dad;
+		const bool is_left = nodes[dad].left == node;
+		Link sister = is_left ? nodes[dad].right : nodes[dad].left;
 
-	// Both are black (replacement may be nullptr (which is considered black))
-	// replacement is thus 'double black'
-recur_fixup_del:                  // FIXME: Don't use labels and gotos, this is not assembly
-	Node* sister = node->sibling(); // is still well-defined.
-	if (!sister) return;            // nothing to do
-
-	if (BLACK == sister->color) { // sister is is black
-		Node* r_left = (sister->left && sister->left->color) ? sister->left : nullptr;
-		Node* r_right = (sister->right && sister->right->color) ? sister->right : nullptr;
+		if (nodes[sister].color == RED) { // rotate sister up, the new sister is black
+			nodes[sister].color = BLACK;
+			nodes[dad].color = RED;
+			rotate(dad, is_left ? LEFT : RIGHT);
+			sister = is_left ? nodes[dad].right : nodes[dad].left;
+		}
 
-		if (!r_left && !r_right) { // sister is black with two black chidlren.
-			sister->color = RED;
-			if (BLACK == sister->dad->color) {
-				node = sister->dad;
-				goto recur_fixup_del; // FIXME: really. fix me.
-			}
-		} else // sister has a red child
-				if (sister->dad->left == sister)
-			if ((r_left && r_right) || r_left) // left left case
-				rotate(sister->dad, RIGHT);
-			else { // left right case
-				rotate(sister, LEFT);
-				rotate(sister->dad, RIGHT);
-			}
-		else if ((r_right && r_left) || r_right) // right right case
-			rotate(sister->dad, LEFT);
-		else {
-			rotate(sister, RIGHT);
-			rotate(sister->dad, LEFT);
+		Link near = is_left ? nodes[sister].left : nodes[sister].right;
+		Link far = is_left ? nodes[sister].right : nodes[sister].left;
+		if (nodes[near].color == BLACK && nodes[far].color == BLACK) {
+			// sister is black with two black children
+			nodes[sister].color = RED;
+			node = dad;
+			continue;
 		}
-	} else { // sister is red
-		sister->color = Color(!sister->color);
-		sister->dad->color = Color(!sister->dad->color);
-		if (sister->dad->left == sister) { // rotate sister up
-			sister->left->color = BLACK;
-			rotate(sister->dad, RIGHT);
-		} else {
-			sister->right->color = BLACK;
-			rotate(sister->dad, LEFT);
+
+		if (nodes[far].color == BLACK) { // only the near child is red, rotate it outwards
+			nodes[near].color = BLACK;
+			nodes[sister].color = RED;
+			rotate(sister, is_left ? RIGHT : LEFT);
+			far = sister;
+			sister = near;
 		}
+
+		nodes[sister].color = nodes[dad].color;
+		nodes[dad].color = BLACK;
+		nodes[far].color = BLACK;
+		rotate(dad, is_left ? LEFT : RIGHT);
+		node = _root;
 	}
+	nodes[node].color = BLACK;
 }
 
 // query a point
 template<class T_key, class T_data, class T_ind>
-T_data _::RB_Interval<T_key, T_data, T_ind>::find(const T_key key) const {
-	Node* tmp_node = _root;
-	Node* last_right = nullptr;
+template<class T_key_of>
+T_data _::RB_Interval<T_key, T_data, T_ind>::find(const T_key key, T_key_of&& key_of) const {
+	Link tmp_node = _root;
+	Link last_right = 0;
+	uint64_t depth = 0;
+	_::count(stats.tree_finds);
 
-	while (true) // location routine
-		if (tmp_node->key > key) {
-			if (tmp_node->left)
-				tmp_node = tmp_node->left;
-			else
-				return last_right->data;
-		} else if (tmp_node->right) {
+	// Find the interval with the greatest lower bound not above key. Keys below all intervals fall
+	// into the lowest one.
+	for (;; ++depth) // location routine
+		if (key_of(nodes[tmp_node].data) > key) {
+			if (nodes[tmp_node].left)
+				tmp_node = nodes[tmp_node].left;
+			else {
+				_::count_max(stats.tree_depth, depth);
+				return nodes[last_right ? last_right : tmp_node].data;
+			}
+		} else if (nodes[tmp_node].right) {
 			last_right = tmp_node;
-			tmp_node = tmp_node->right;
-		} else
-			return tmp_node->data;
+			tmp_node = nodes[tmp_node].right;
+		} else {
+			_::count_max(stats.tree_depth, depth);
+			return nodes[tmp_node].data;
+		}
 }
 } // namespace fmt
 #endif
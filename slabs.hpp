@@ -0,0 +1,204 @@
+#ifndef FMT_SLABS_H
+#define FMT_SLABS_H
+// Defines helper structs for the partition of a polygon in vertical slabs in ./slabs.ipp
+
+#include "partition.hpp"
+
+#include <cstdint>
+#include <set>
+#include <vector>
+
+namespace fmt {
+
+// Forward Declarations
+template<class T_vert, class T_ind>
+class Polygon;
+
+// Detail namespace
+namespace _ {
+/*! Chain of the polygon between two consecutive event vertices of a ring, as seen by the sweep of
+	one slab. Not meant for external use.
+
+	Chains are x-monotone. Upper chains bound the polygon from above and run from left to right in
+	index order, lower chains bound it from below and run from left to right against index order. The
+	region between a lower chain and the upper chain above it is kept on the lower chain.
+*/
+template<class T_ind>
+struct SlabChain {
+	T_ind chain;       //!< Event vertex starting the chain on its ring, which identifies the chain
+	T_ind left, right; //!< Vertices ending the chain in sweep order
+	T_ind first, last; //!< First and last vertex of the ring, to step along the chain
+	T_ind cursor;      //!< Last vertex of the chain swept
+	bool is_upper;     //!< Whether the chain bounds the polygon from above
+
+	// Region above a lower chain
+	T_ind helper;     //!< Last event vertex of the region in the slab, or null_index if none
+	T_ind after;      //!< First vertex of the region after a pending merge vertex in helper
+	T_ind entry;      //!< First vertex of the region right of the left bound of the slab
+	bool is_pending;  //!< Whether helper is a merge vertex still waiting for its diagonal
+	bool is_entering; //!< Whether the region crosses the left bound and has not met an event yet
+};
+
+//! First vertex a region crossing the left bound of a slab meets in the slab
+template<class T_ind>
+struct SlabEntry {
+	T_ind chain; //!< Lower chain of the region
+	T_ind first; //!< First vertex of the region in the slab
+	T_ind split; //!< first, if it is a split vertex needing a diagonal to the helper, else null_index
+};
+
+//! State a region leaves a slab in at its right bound
+template<class T_ind>
+struct SlabExit {
+	T_ind chain;     //!< Lower chain of the region
+	T_ind helper;    //!< Last vertex of the region in the slab
+	bool is_pending; //!< Whether helper is a merge vertex still waiting for its diagonal
+};
+
+//! Diagonals and boundary states found by the sweep of one slab
+template<class T_ind>
+struct SlabResult {
+	std::vector<T_ind> diagonals;           //!< Pairs of vertices
+	std::vector<SlabEntry<T_ind>> entries; //!< Regions entering the slab, in sweep order
+	std::vector<SlabExit<T_ind>> exits;    //!< Regions leaving the slab
+};
+
+//! Half-edge around a vertex, used to walk the faces formed by the diagonals
+template<class T_ind>
+struct Spoke {
+	T_ind from, to; //!< Vertices of the half-edge
+	T_ind edge;     //!< Half-edge id, or null_index for an edge running against the ring
+};
+
+/*! Shared state of the partition in slabs. Not meant for external use.
+
+	Each chain of the polygon is identified by the index of the event vertex starting it on its
+	ring, see Polygon::find_events.
+*/
+template<class T_vert, class T_ind>
+struct Slabs {
+	std::vector<T_vert> bounds; //!< x coordinates separating the slabs
+	std::vector<T_vert> sample; //!< Sample of event x coordinates to choose the bounds from
+
+	std::vector<T_ind> event_slabs;   //!< Slab of each event vertex
+	std::vector<T_ind> event_offsets; //!< First event of each slab in events
+	std::vector<T_ind> events;        //!< Event vertices grouped by slab
+
+	std::vector<T_ind> present_offsets; //!< First chain crossing the left bound of each slab
+	std::vector<T_ind> presents;        //!< Chains crossing the left bound of each slab, by slab
+	std::vector<T_ind> chain_slabs;     //!< Slab each chain starts in
+	std::vector<T_ind> created;         //!< Index of each chain in the sweep of the slab it starts in
+
+	std::vector<SlabResult<T_ind>> results; //!< Result of each slab
+
+	std::vector<T_ind> helpers;     //!< Last vertex of the region above each lower chain so far
+	std::vector<uint8_t> pendings;  //!< Whether that vertex is a merge vertex waiting for a diagonal
+	std::vector<T_ind> diagonals;   //!< Pairs of vertices of all diagonals
+
+	std::vector<Spoke<T_ind>> spokes; //!< Half-edges around the ends of diagonals, ordered by angle
+	std::vector<T_ind> spoke_firsts;  //!< First spoke of each vertex, or null_index if it has none
+	std::vector<T_ind> spoke_edges;   //!< Spoke of each half-edge leaving the end of a diagonal
+	std::vector<T_ind> spoke_backs;   //!< Spoke running against the ring of each end of a diagonal
+	//! Head, first upper, first lower and tail vertex and slot of the parts found in each chunk of
+	//! vertices
+	std::vector<std::vector<T_ind>> found;
+
+	//! Position of the part created by each start and split vertex in Polygon::partition, by vertex
+	std::vector<T_ind> slots;
+	std::vector<uint8_t> is_start;        //!< Whether each vertex is a start vertex
+	std::vector<const T_ind*> slot_parts; //!< Part found for each slot, or nullptr if none
+};
+
+/*! Sweep over one slab of a polygon, partitioning it into monotone parts by diagonals to the
+	helper of each region as in de Berg et al., "Computational Geometry", chapter 3. Not meant for
+	external use.
+
+	Regions crossing the left bound of the slab do not know their helper. Their first vertex in the
+	slab is recorded as an entry instead, and the state of every region at the right bound as an
+	exit, so that Polygon::partition_slabs can add the diagonals across bounds afterwards.
+*/
+template<class T_vert, class T_ind>
+class SlabSweep {
+private:
+	//! Orders the chains crossing the sweep from bottom to top. See SlabSweep::is_below.
+	struct ChainOrder {
+		const SlabSweep* self;
+		bool operator()(const T_ind a, const T_ind b) const { return self->is_below(a, b); }
+	};
+
+	typedef std::set<T_ind, ChainOrder> Status;
+	typedef typename Coord<T_vert>::Real Real; //!< Type of heights interpolated along chains
+
+	const Polygon<T_vert, T_ind>* poly = nullptr; //!< Polygon swept
+	const T_ind* ring_offsets = nullptr;          //!< Rings of the polygon
+	T_ind rings = T_ind(0);                       //!< Number of rings
+
+	//! Chains seen by the sweep. Their cursors advance lazily as they are compared.
+	mutable std::vector<SlabChain<T_ind>> chains;
+	Status status{ChainOrder{this}};                 //!< Chains crossing the sweep
+	std::vector<typename Status::iterator> positions; //!< Position of each chain in status
+
+	T_vert begin_x = T_vert(0), end_x = T_vert(0); //!< Bounds of the slab
+	bool is_first = true, is_last = true;          //!< Whether the slab has no left or right bound
+	T_vert sweep_x = T_vert(0), sweep_y = T_vert(0); //!< The current event
+	T_ind sweep_i = T_ind(0);                        //!< Index of the current event
+	SlabResult<T_ind>* result = nullptr;             //!< Result of the slab
+
+	std::vector<T_ind> order; //!< Chains crossing the left bound, to sort them by height
+
+	//! Whether vertex a is swept before vertex b, see _::is_before
+	bool before(const T_ind a, const T_ind b) const;
+
+	//! Get the vertex following v on a chain
+	T_ind step(const SlabChain<T_ind>& c, const T_ind v) const {
+		return c.is_upper ? (v == c.last ? c.first : v + 1) : (v == c.first ? c.last : v - 1);
+	}
+
+	//! Whether a vertex lies right of the left bound of the slab
+	bool is_inside(const T_ind v) const { return is_first || !(poly->x(v) < begin_x); }
+
+	//! Move the cursor of a chain to the last vertex swept
+	void advance(SlabChain<T_ind>& c) const;
+
+	//! Get the height of a chain at the sweep. Vertical edges are clamped to the sweep, see
+	//! _::is_before. null_index stands for the current event itself.
+	Real sweep_y_of(const T_ind chain) const;
+
+	//! Whether a chain lies below another at the sweep, or leaves below it where they meet
+	bool is_below(const T_ind a, const T_ind b) const;
+
+	//! Get a chain as it starts, given the event vertex starting it on its ring
+	SlabChain<T_ind> chain_of(const std::vector<EventVertex<T_ind>>& evs, const T_ind chain) const;
+
+	//! Add a chain starting at the current event and insert it into status
+	T_ind create(const std::vector<EventVertex<T_ind>>& evs, const T_ind chain,
+							 std::vector<T_ind>& created);
+
+	//! Add a chain crossing the left bound of the slab, with its cursor at the last vertex left of it
+	T_ind enter(const std::vector<EventVertex<T_ind>>& evs, const T_ind chain);
+
+	//! Let an event vertex reach the region above a lower chain. Resolves a pending merge vertex
+	//! and records the entry of a region crossing the left bound.
+	//! @return The helper to connect a split vertex to, or null_index if there is none in the slab
+	//! or the diagonal has been added already.
+	T_ind reach(const T_ind chain, const T_ind vert, const bool is_split);
+
+	//! Add a diagonal to the result
+	void push_diagonal(const T_ind a, const T_ind b) {
+		result->diagonals.push_back(a);
+		result->diagonals.push_back(b);
+	}
+
+public:
+	SlabSweep() = default;
+	SlabSweep(const SlabSweep&) {} //!< Sweeps hold no state between slabs, so copies start empty
+	SlabSweep& operator=(const SlabSweep&) { return *this; }
+
+	//! Sweep a slab of a polygon
+	void sweep(const Polygon<T_vert, T_ind>& poly, const std::vector<T_ind>& ring_offsets,
+						 const std::vector<EventVertex<T_ind>>& evs, Slabs<T_vert, T_ind>& slabs,
+						 const T_ind slab);
+};
+} // namespace _
+} // namespace fmt
+#endif
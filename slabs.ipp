@@ -0,0 +1,654 @@
+#ifndef FMT_SLABS_IPP
+#define FMT_SLABS_IPP
+/* Implements the partition of a polygon into monotone parts in vertical slabs, which are swept in
+ * parallel. See fmt::Polygon::partition_slabs.
+ */
+
+#include "parallel.hpp"
+#include "partition.hpp"
+#include "polygon.hpp"
+#include "slabs.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <numeric>
+
+template<class T_vert, class T_ind>
+bool fmt::_::SlabSweep<T_vert, T_ind>::before(const T_ind a, const T_ind b) const {
+	return is_before(poly->x(a), poly->y(a), a, poly->x(b), poly->y(b), b);
+}
+
+template<class T_vert, class T_ind>
+void fmt::_::SlabSweep<T_vert, T_ind>::advance(SlabChain<T_ind>& c) const {
+	while (c.cursor != c.right) {
+		const T_ind next = step(c, c.cursor);
+		if (is_before(sweep_x, sweep_y, sweep_i, poly->x(next), poly->y(next), next)) return;
+		c.cursor = next;
+	}
+}
+
+template<class T_vert, class T_ind>
+typename fmt::_::Coord<T_vert>::Real
+		fmt::_::SlabSweep<T_vert, T_ind>::sweep_y_of(const T_ind chain) const {
+	if (chain == null_index<T_ind>()) return Real(sweep_y);
+
+	SlabChain<T_ind>& c = chains[chain];
+	advance(c);
+	const T_ind l = c.cursor;
+	if (l == c.right) return Real(poly->y(l));
+
+	const T_ind r = step(c, l);
+	const T_vert x_l = poly->x(l), y_l = poly->y(l), x_r = poly->x(r), y_r = poly->y(r);
+	if (x_l == x_r) return Real(std::max(y_l, std::min(sweep_y, y_r)));
+	if (x_l == sweep_x) return Real(y_l);
+	if (x_r == sweep_x) return Real(y_r);
+	return Real(y_l) +
+				 (Real(y_r) - Real(y_l)) * (Real(sweep_x) - Real(x_l)) / (Real(x_r) - Real(x_l));
+}
+
+template<class T_vert, class T_ind>
+bool fmt::_::SlabSweep<T_vert, T_ind>::is_below(const T_ind a, const T_ind b) const {
+	const Real y_a = sweep_y_of(a), y_b = sweep_y_of(b);
+	if (y_a != y_b) return y_a < y_b;
+	if (a == b || a == null_index<T_ind>() || b == null_index<T_ind>()) return false;
+
+	// Chains meeting at the sweep are ordered by the direction they leave or arrive in
+	const SlabChain<T_ind>&c_a = chains[a], &c_b = chains[b];
+	const T_ind l_a = c_a.cursor, l_b = c_b.cursor;
+	const T_ind r_a = l_a == c_a.right ? l_a : step(c_a, l_a);
+	const T_ind r_b = l_b == c_b.right ? l_b : step(c_b, l_b);
+	auto side = [this](const T_ind from, const T_ind to, const T_ind vert) {
+		return orientation(poly->x(from), poly->y(from), poly->x(to), poly->y(to), poly->x(vert),
+											 poly->y(vert));
+	};
+	int turn = 0;
+	if (l_a == l_b)
+		turn = side(l_a, r_a, r_b);
+	else if (r_a == r_b)
+		turn = side(l_a, r_a, l_b);
+	else {
+		auto dx = [this](const T_ind from, const T_ind to) {
+			return Real(poly->x(to)) - Real(poly->x(from));
+		};
+		auto dy = [this](const T_ind from, const T_ind to) {
+			return Real(poly->y(to)) - Real(poly->y(from));
+		};
+		const Real cross = dx(l_a, r_a) * dy(l_b, r_b) - dy(l_a, r_a) * dx(l_b, r_b);
+		turn = cross > Real(0) ? 1 : cross < Real(0) ? -1 : 0;
+	}
+	return turn ? turn > 0 : a < b;
+}
+
+template<class T_vert, class T_ind>
+fmt::_::SlabChain<T_ind>
+		fmt::_::SlabSweep<T_vert, T_ind>::chain_of(const std::vector<EventVertex<T_ind>>& evs,
+																							 const T_ind chain) const {
+	const T_ind null = null_index<T_ind>();
+	const T_ind a = evs[chain].index, b = evs[evs[chain].next].index;
+	const T_ind ring = std::upper_bound(ring_offsets, ring_offsets + rings + 1, a) - ring_offsets - 1;
+
+	SlabChain<T_ind> c;
+	c.chain = chain;
+	c.is_upper = before(a, b);
+	c.left = c.is_upper ? a : b;
+	c.right = c.is_upper ? b : a;
+	c.first = ring_offsets[ring];
+	c.last = ring_offsets[ring + 1] - 1;
+	c.cursor = c.left;
+	c.helper = c.after = c.entry = null;
+	c.is_pending = c.is_entering = false;
+	return c;
+}
+
+template<class T_vert, class T_ind>
+T_ind fmt::_::SlabSweep<T_vert, T_ind>::create(const std::vector<EventVertex<T_ind>>& evs,
+																							 const T_ind chain, std::vector<T_ind>& created) {
+	chains.push_back(chain_of(evs, chain));
+	created[chain] = chains.size() - 1;
+	positions.push_back(status.insert(chains.size() - 1).first);
+	return chains.size() - 1;
+}
+
+template<class T_vert, class T_ind>
+T_ind fmt::_::SlabSweep<T_vert, T_ind>::enter(const std::vector<EventVertex<T_ind>>& evs,
+																							const T_ind chain) {
+	SlabChain<T_ind> c = chain_of(evs, chain);
+	c.is_entering = !c.is_upper;
+
+	// Binary search for the last vertex left of the bound. The chain runs through the ring from
+	// left to right, possibly wrapping around its end.
+	const T_ind size = c.last - c.first + 1;
+	auto vertex_at = [&c, size](const T_ind offset) {
+		const T_ind from = c.left - c.first;
+		return c.first + (c.is_upper ? (from + offset) % size : (from + size - offset) % size);
+	};
+	T_ind low = T_ind(0), high = c.is_upper ? (c.right + size - c.left) % size
+																				 : (c.left + size - c.right) % size;
+	while (high - low > 1) {
+		const T_ind mid = low + (high - low) / 2;
+		if (poly->x(vertex_at(mid)) < begin_x)
+			low = mid;
+		else
+			high = mid;
+	}
+	c.cursor = vertex_at(low);
+
+	chains.push_back(c);
+	positions.push_back(status.end());
+	return chains.size() - 1;
+}
+
+template<class T_vert, class T_ind>
+T_ind fmt::_::SlabSweep<T_vert, T_ind>::reach(const T_ind chain, const T_ind vert,
+																							const bool is_split) {
+	const T_ind null = null_index<T_ind>();
+	SlabChain<T_ind>& c = chains[chain];
+
+	if (c.is_entering) {
+		// The helper lies left of the slab. Connecting to it is left to the stitching.
+		c.is_entering = false;
+		const T_ind first = before(c.entry, vert) ? c.entry : vert;
+		result->entries.push_back(SlabEntry<T_ind>{c.chain, first, is_split && first == vert ? vert : null});
+	} else if (c.is_pending) {
+		// The merge vertex connects to the first vertex after it
+		c.is_pending = false;
+		const T_ind to = c.after != null && before(c.after, vert) ? c.after : vert;
+		push_diagonal(c.helper, to);
+		if (to == vert) return null;
+	}
+	if (!is_split) return null;
+
+	// The helper is the last vertex of the region swept, on either chain or an event
+	SlabChain<T_ind>& upper = chains[*std::next(positions[chain])];
+	advance(c);
+	advance(upper);
+	T_ind helper = c.helper;
+	if (is_inside(c.cursor) && (helper == null || before(helper, c.cursor))) helper = c.cursor;
+	if (is_inside(upper.cursor) && (helper == null || before(helper, upper.cursor)))
+		helper = upper.cursor;
+	return helper;
+}
+
+template<class T_vert, class T_ind>
+void fmt::_::SlabSweep<T_vert, T_ind>::sweep(const Polygon<T_vert, T_ind>& polygon,
+																						 const std::vector<T_ind>& offsets,
+																						 const std::vector<EventVertex<T_ind>>& evs,
+																						 Slabs<T_vert, T_ind>& slabs, const T_ind slab) {
+	const T_ind null = null_index<T_ind>();
+	poly = &polygon;
+	ring_offsets = offsets.data();
+	rings = offsets.size() - 1;
+
+	is_first = slab == T_ind(0);
+	is_last = slab == slabs.bounds.size();
+	begin_x = is_first ? T_vert(0) : slabs.bounds[slab - 1];
+	end_x = is_last ? T_vert(0) : slabs.bounds[slab];
+
+	result = &slabs.results[slab];
+	result->diagonals.clear();
+	result->entries.clear();
+	result->exits.clear();
+	chains.clear();
+	positions.clear();
+	status.clear();
+
+	// Order the events of the slab
+	T_ind* const events = slabs.events.data() + slabs.event_offsets[slab];
+	T_ind* const events_end = slabs.events.data() + slabs.event_offsets[slab + 1];
+	std::sort(events, events_end,
+						[this, &evs](const T_ind a, const T_ind b) { return before(evs[a].index, evs[b].index); });
+
+	// Enter the chains crossing the left bound, from bottom to top. A sweep just left of the bound
+	// passes no vertex on it.
+	sweep_x = begin_x;
+	sweep_y = std::numeric_limits<T_vert>::lowest();
+	sweep_i = T_ind(0);
+	const T_ind* const presents = slabs.presents.data() + slabs.present_offsets[slab];
+	const T_ind* const presents_end = slabs.presents.data() + slabs.present_offsets[slab + 1];
+	for (const T_ind* it = presents; it != presents_end; ++it)
+		enter(evs, *it);
+
+	order.resize(chains.size());
+	std::iota(order.begin(), order.end(), T_ind(0));
+	std::sort(order.begin(), order.end(),
+						[this](const T_ind a, const T_ind b) { return is_below(a, b); });
+	for (auto&& it = order.cbegin(); it != order.cend(); ++it)
+		positions[*it] = status.insert(status.end(), *it);
+
+	// The first vertex of each entering region lies on either of its chains
+	for (auto&& it = status.cbegin(); it != status.cend(); ++it) {
+		SlabChain<T_ind>& c = chains[*it];
+		if (c.is_upper) continue;
+		const T_ind low = step(c, c.cursor), high = step(chains[*std::next(it)], chains[*std::next(it)].cursor);
+		c.entry = before(low, high) ? low : high;
+	}
+
+	// Local index of a chain ending in the slab
+	auto local = [&](const T_ind chain) -> T_ind {
+		if (slabs.chain_slabs[chain] == slab) return slabs.created[chain];
+		return std::lower_bound(presents, presents_end, chain) - presents;
+	};
+
+	for (const T_ind* it = events; it != events_end; ++it) {
+		const T_ind ev = *it, vert = evs[ev].index;
+		sweep_x = poly->x(vert);
+		sweep_y = poly->y(vert);
+		sweep_i = vert;
+
+		switch (evs[ev].type) {
+		case START: {
+			// Both chains leave to the right, the one following the vertex above
+			const T_ind lower = create(evs, evs[ev].prev, slabs.created);
+			create(evs, ev, slabs.created);
+			chains[lower].helper = vert;
+			break;
+		}
+		case SPLIT: {
+			// The region containing the vertex is divided. The lower part keeps its chain.
+			const T_ind region = *std::prev(status.lower_bound(null));
+			const T_ind helper = reach(region, vert, true);
+			if (helper != null) push_diagonal(vert, helper);
+
+			create(evs, ev, slabs.created);
+			const T_ind upper = create(evs, evs[ev].prev, slabs.created);
+			chains[region].helper = vert;
+			chains[upper].helper = vert;
+			break;
+		}
+		case MERGE: {
+			// The regions above and below the vertex are joined. The vertex waits for the next one.
+			const T_ind upper = local(ev), lower_end = local(evs[ev].prev);
+			const T_ind region = *std::prev(positions[lower_end]);
+			reach(upper, vert, false);
+			reach(region, vert, false);
+			status.erase(positions[upper]);
+			status.erase(positions[lower_end]);
+
+			SlabChain<T_ind>&c = chains[region], &above = chains[*std::next(positions[region])];
+			advance(c);
+			advance(above);
+			c.helper = vert;
+			c.is_pending = true;
+			c.after = null;
+			if (c.cursor != c.right) c.after = step(c, c.cursor);
+			if (above.cursor != above.right) {
+				const T_ind next = step(above, above.cursor);
+				if (c.after == null || before(next, c.after)) c.after = next;
+			}
+			break;
+		}
+		default: {
+			// STOP: the region ends
+			const T_ind region = local(ev);
+			reach(region, vert, false);
+			status.erase(positions[region]);
+			status.erase(positions[local(evs[ev].prev)]);
+			break;
+		}
+		}
+	}
+	if (is_last) return;
+
+	// Leave the slab at its right bound
+	sweep_x = end_x;
+	sweep_y = std::numeric_limits<T_vert>::lowest();
+	sweep_i = T_ind(0);
+	for (auto&& it = status.cbegin(); it != status.cend(); ++it) {
+		SlabChain<T_ind>& c = chains[*it];
+		if (c.is_upper) continue;
+		SlabChain<T_ind>& upper = chains[*std::next(it)];
+		advance(c);
+		advance(upper);
+
+		T_ind helper = c.helper;
+		if (c.is_entering) {
+			if (!(poly->x(c.entry) < end_x)) continue; // passes the slab without a vertex
+			result->entries.push_back(SlabEntry<T_ind>{c.chain, c.entry, null});
+		} else if (c.is_pending) {
+			if (c.after == null || !(poly->x(c.after) < end_x)) {
+				result->exits.push_back(SlabExit<T_ind>{c.chain, helper, true});
+				continue;
+			}
+			push_diagonal(helper, c.after);
+		}
+		if (is_inside(c.cursor) && (helper == null || before(helper, c.cursor))) helper = c.cursor;
+		if (is_inside(upper.cursor) && (helper == null || before(helper, upper.cursor)))
+			helper = upper.cursor;
+		result->exits.push_back(SlabExit<T_ind>{c.chain, helper, false});
+	}
+}
+
+namespace fmt {
+
+template<class T_vert, class T_ind>
+std::vector<MonoPart<T_ind>>& Polygon<T_vert, T_ind>::partition_slabs(Workspace<T_vert, T_ind>& ws,
+																																			unsigned threads,
+																																			const T_ind slab_events) {
+	const T_ind null = _::null_index<T_ind>();
+	const T_ind n = size();
+	ws.clear();
+	ws.start();
+	if (!threads) threads = _::default_threads();
+
+	/* Stage 1: Building the event set, see Polygon::partition */
+	find_events(ws);
+	ws.lap(EVENTS);
+	if (keep_monotone(ws)) return ws.parts;
+	const std::vector<_::EventVertex<T_ind>>& evs = ws.evs;
+	const T_ind count = evs.size();
+	_::Slabs<T_vert, T_ind>& slabs = ws.slabs;
+
+	// The parts are the ones the single sweep finds. Order them the same way: the sweep creates the
+	// parts of the start vertices attached to each split vertex, then the part of the split vertex.
+	order_splits(ws);
+	std::vector<T_ind>& slots = slabs.slots;
+	std::vector<uint8_t>& is_start = slabs.is_start;
+	slots.assign(n, null);
+	is_start.assign(n, false);
+	T_ind n_slots = T_ind(0);
+	for (auto&& it = ws.split_order.cbegin(); it != ws.split_order.cend(); ++it) {
+		for (T_ind s = (*it)->starts; s != null; s = evs[s].next_start) {
+			slots[evs[s].index] = n_slots++;
+			is_start[evs[s].index] = true;
+		}
+		if (it + 1 != ws.split_order.cend()) slots[evs[(*it)->event].index] = n_slots++;
+	}
+
+	/* Stage 2: Cutting the polygon into slabs */
+	/*
+		The bounds are quantiles of a sample of the x coordinates of the events, so that each slab
+		holds about the same number of events. Every chain crossing a bound is entered by the slab
+		right of it, which takes a binary search along the chain. Where many chains run side by side,
+		e.g. along the spikes of a star, this would outweigh the sweep itself, so the number of slabs
+		is halved until no more chains cross bounds than there are events. The bounds depend on the
+		polygon only and not on the number of threads, which keeps the partition the same for any
+		number of threads.
+	*/
+	constexpr T_ind max_slabs = T_ind(256);
+	T_ind wanted = std::max(T_ind(1), std::min(max_slabs, T_ind(count / slab_events)));
+	std::vector<T_vert>& bounds = slabs.bounds;
+	std::vector<T_vert>& sample = slabs.sample;
+	sample.clear();
+	const T_ind every = std::max(T_ind(1), T_ind(count / (wanted * 16)));
+	for (T_ind i = T_ind(0); i < count && wanted > 1; i += every)
+		sample.push_back(x(evs[i].index));
+	std::sort(sample.begin(), sample.end());
+
+	auto slab_of = [&bounds](const T_vert x) -> T_ind {
+		return std::upper_bound(bounds.cbegin(), bounds.cend(), x) - bounds.cbegin();
+	};
+	slabs.event_slabs.resize(count);
+	slabs.chain_slabs.resize(count);
+	slabs.created.resize(count);
+	T_ind n_slabs;
+	for (;; wanted /= 2) {
+		bounds.clear();
+		for (T_ind k = T_ind(1); k < wanted; ++k) {
+			const T_vert bound = sample[k * sample.size() / wanted];
+			if (bound > sample.front() && (bounds.empty() || bound > bounds.back()))
+				bounds.push_back(bound);
+		}
+		n_slabs = bounds.size() + 1;
+		for (T_ind e = T_ind(0); e < count; ++e)
+			slabs.event_slabs[e] = slab_of(x(evs[e].index));
+
+		// A chain crosses the left bound of every slab after the one it starts in, up to the one it
+		// ends in. Count the chains crossing each bound by their differences.
+		slabs.present_offsets.assign(n_slabs + 2, T_ind(0));
+		for (T_ind e = T_ind(0); e < count; ++e) {
+			const T_ind a = slabs.event_slabs[e], b = slabs.event_slabs[evs[e].next];
+			slabs.chain_slabs[e] = std::min(a, b);
+			++slabs.present_offsets[std::min(a, b) + 2];
+			--slabs.present_offsets[std::max(a, b) + 2];
+		}
+		T_ind crossings = T_ind(0), total = T_ind(0);
+		for (T_ind k = T_ind(2); k < n_slabs + 2; ++k) {
+			crossings += slabs.present_offsets[k];
+			slabs.present_offsets[k] = crossings;
+			total += crossings;
+		}
+		if (n_slabs == T_ind(1) || total <= count) break;
+	}
+	slabs.present_offsets.pop_back();
+
+	// Group the events by slab
+	slabs.event_offsets.assign(n_slabs + 1, T_ind(0));
+	for (T_ind e = T_ind(0); e < count; ++e)
+		++slabs.event_offsets[slabs.event_slabs[e] + 1];
+	std::partial_sum(slabs.event_offsets.begin(), slabs.event_offsets.end(),
+									 slabs.event_offsets.begin());
+	slabs.events.resize(count);
+	for (T_ind e = T_ind(0); e < count; ++e)
+		slabs.events[slabs.event_offsets[slabs.event_slabs[e]]++] = e;
+	for (T_ind k = n_slabs; k > T_ind(0); --k)
+		slabs.event_offsets[k] = slabs.event_offsets[k - 1];
+	slabs.event_offsets[0] = T_ind(0);
+
+	// Group the chains crossing bounds by slab
+	std::partial_sum(slabs.present_offsets.begin(), slabs.present_offsets.end(),
+									 slabs.present_offsets.begin());
+	slabs.presents.resize(slabs.present_offsets.back());
+	for (T_ind e = T_ind(0); e < count; ++e) {
+		const T_ind a = slabs.event_slabs[e], b = slabs.event_slabs[evs[e].next];
+		for (T_ind k = std::min(a, b) + 1; k <= std::max(a, b); ++k)
+			slabs.presents[slabs.present_offsets[k]++] = e;
+	}
+	for (T_ind k = n_slabs; k > T_ind(0); --k)
+		slabs.present_offsets[k] = slabs.present_offsets[k - 1];
+	slabs.present_offsets[0] = T_ind(0);
+
+	/* Stage 3: Sweeping the slabs in parallel */
+	if (slabs.results.size() < n_slabs) slabs.results.resize(n_slabs);
+	if (ws.slab_sweeps.size() < threads) ws.slab_sweeps.resize(threads);
+	_::parallel_for(n_slabs, T_ind(1), threads, [&](const T_ind begin, const T_ind end,
+																								 const unsigned thread) {
+		for (T_ind k = begin; k < end; ++k)
+			ws.slab_sweeps[thread].sweep(*this, ring_offsets, evs, slabs, k);
+	});
+
+	/* Stage 4: Stitching the slabs */
+	/*
+		Walk the bounds from left to right, carrying the helper of each region across. A merge
+		vertex left pending at a bound connects to the first vertex of its region in the next slab,
+		and a split vertex without a helper in its slab connects to the helper left of it.
+	*/
+	std::vector<T_ind>& diagonals = slabs.diagonals;
+	diagonals.clear();
+	slabs.helpers.resize(count);
+	slabs.pendings.resize(count);
+	for (T_ind k = T_ind(0); k < n_slabs; ++k) {
+		const _::SlabResult<T_ind>& result = slabs.results[k];
+		for (auto&& it = result.entries.cbegin(); it != result.entries.cend(); ++it) {
+			const T_ind helper = slabs.helpers[it->chain];
+			if (slabs.pendings[it->chain]) {
+				diagonals.push_back(helper);
+				diagonals.push_back(it->first);
+			} else if (it->split != null) {
+				diagonals.push_back(it->split);
+				diagonals.push_back(helper);
+			}
+		}
+		for (auto&& it = result.exits.cbegin(); it != result.exits.cend(); ++it) {
+			slabs.helpers[it->chain] = it->helper;
+			slabs.pendings[it->chain] = it->is_pending;
+		}
+		diagonals.insert(diagonals.end(), result.diagonals.cbegin(), result.diagonals.cend());
+	}
+
+	/* Stage 5: Building the parts */
+	/*
+		Every half-edge of the polygon and of the diagonals bounds exactly one part on its right. The
+		half-edge following one on its part is the one leaving the vertex it ends in next
+		counter-clockwise from it, which only needs looking up at the ends of diagonals. Each part is
+		walked from its first vertex, the only one both of whose neighbours on the part are swept
+		after it. This finds its last vertex, and the links of the ends of diagonals on its chains.
+		Half-edge i < n runs from vertex i to the next one on its ring, half-edge n + j from
+		diagonals[j] to diagonals[j ^ 1]. The vertices are handled in chunks of fixed size in
+		parallel. The parts are then put in the order Polygon::partition creates them, see slot_of.
+	*/
+	const T_ind n_diagonals = diagonals.size();
+	std::vector<_::Spoke<T_ind>>& spokes = slabs.spokes;
+	std::vector<T_ind>& firsts = slabs.spoke_firsts;
+	std::vector<T_ind>& backs = slabs.spoke_backs;
+	std::vector<T_ind>& edges = slabs.spoke_edges;
+
+	// Group the spokes by vertex, the edges of the ring first
+	firsts.assign(n, T_ind(0));
+	backs.resize(n);
+	edges.resize(n + n_diagonals);
+	for (T_ind j = T_ind(0); j < n_diagonals; ++j)
+		++firsts[diagonals[j]];
+	spokes.clear();
+	for (T_ind v = T_ind(0); v < n; ++v) {
+		const T_ind degree = firsts[v];
+		if (!degree) {
+			firsts[v] = null;
+			continue;
+		}
+		firsts[v] = spokes.size();
+		backs[v] = spokes.size() + 2; // where the next diagonal goes
+		spokes.push_back(_::Spoke<T_ind>{v, nexts[v], v});
+		spokes.push_back(_::Spoke<T_ind>{v, prevs[v], null});
+		spokes.resize(spokes.size() + degree);
+	}
+	for (T_ind j = T_ind(0); j < n_diagonals; ++j)
+		spokes[backs[diagonals[j]]++] = _::Spoke<T_ind>{diagonals[j], diagonals[j ^ 1], T_ind(n + j)};
+
+	constexpr T_ind chunk = T_ind(1) << 14;
+	const T_ind n_chunks = (n + chunk - 1) / chunk;
+
+	// Order the spokes of each vertex counter-clockwise, starting from the positive x-axis
+	auto half = [this](const _::Spoke<T_ind>& s) {
+		return y(s.to) < y(s.from) || (y(s.to) == y(s.from) && x(s.to) < x(s.from));
+	};
+	auto ccw = [this, &half](const _::Spoke<T_ind>& a, const _::Spoke<T_ind>& b) {
+		const bool half_a = half(a), half_b = half(b);
+		if (half_a != half_b) return half_b;
+		return _::orientation(x(a.from), y(a.from), x(a.to), y(a.to), x(b.to), y(b.to)) > 0;
+	};
+	_::parallel_for(n_chunks, T_ind(1), threads, [&](const T_ind begin, const T_ind, const unsigned) {
+		for (T_ind v = begin * chunk; v < std::min(n, T_ind((begin + 1) * chunk)); ++v) {
+			if (firsts[v] == null) continue;
+			const T_ind first = firsts[v], end = backs[v];
+			std::sort(spokes.begin() + first, spokes.begin() + end, ccw);
+			for (T_ind k = first; k < end; ++k)
+				if (spokes[k].edge == null)
+					backs[v] = k;
+				else
+					edges[spokes[k].edge] = k;
+		}
+	});
+
+	auto target = [&](const T_ind edge) -> T_ind {
+		if (edge >= n) return diagonals[(edge - n) ^ 1];
+		return firsts[edge] == null ? nexts[edge] : spokes[edges[edge]].to;
+	};
+	auto follow = [&](const T_ind edge) -> T_ind {
+		const T_ind to = target(edge);
+		if (firsts[to] == null) return to;
+
+		// The spoke back along the edge, then the one after it counter-clockwise
+		T_ind k = edge < n ? backs[to] : edges[n + ((edge - n) ^ 1)];
+		if (++k == spokes.size() || spokes[k].from != to) k = firsts[to];
+		return spokes[k].edge;
+	};
+
+	// Slot of a part, see Slabs::slots. A start vertex creates the part along the edge following
+	// it, any other part is created by the last start or split vertex connected to its head by a
+	// diagonal. The links of the head may be changed by other walks, its spokes still hold its
+	// neighbours.
+	auto slot_of = [&](const T_ind head, const T_ind first_upper, const T_ind first_lower) {
+		const T_ind next = target(head),
+								prev = firsts[head] == null ? prevs[head] : spokes[backs[head]].to;
+		if (is_start[head] && first_upper == next) return slots[head];
+		T_ind slot = null;
+		if (first_upper != next) slot = slots[first_upper];
+		if (first_lower != prev && slots[first_lower] != null &&
+				(slot == null || slots[first_lower] > slot))
+			slot = slots[first_lower];
+		return slot;
+	};
+
+	// Walk a part given its first vertex, the vertex before it and the half-edge leaving it. Only
+	// the links of the ends of diagonals change, which no other walk reads.
+	auto walk = [&](const T_ind head, const T_ind first_lower, const T_ind start,
+									std::vector<T_ind>& found) {
+		const T_ind first_upper = target(start);
+		T_ind edge = start, from = head, tail = head;
+		for (T_ind vert = first_upper; vert != head; vert = target(edge)) {
+			const T_ind next = follow(edge), to = target(next);
+			const bool from_left = before(from, vert), to_right = before(vert, to);
+			if (from_left && !to_right)
+				tail = vert;
+			else if (firsts[vert] != null) {
+				// The upper chain is walked along nexts from left to right, the lower one along prevs
+				if (from_left)
+					nexts[vert] = to;
+				else
+					prevs[vert] = from;
+			}
+			from = vert;
+			edge = next;
+		}
+		found.push_back(head);
+		found.push_back(first_upper);
+		found.push_back(first_lower);
+		found.push_back(tail);
+		found.push_back(slot_of(head, first_upper, first_lower));
+	};
+
+	if (slabs.found.size() < n_chunks) slabs.found.resize(n_chunks);
+	_::parallel_for(n_chunks, T_ind(1), threads, [&](const T_ind begin, const T_ind, const unsigned) {
+		std::vector<T_ind>& found = slabs.found[begin];
+		found.clear();
+		for (T_ind v = begin * chunk; v < std::min(n, T_ind((begin + 1) * chunk)); ++v) {
+			if (firsts[v] == null) {
+				if (before(v, prevs[v]) && before(v, nexts[v])) walk(v, prevs[v], v, found);
+				continue;
+			}
+			// Each pair of spokes next to each other encloses a part, unless it is outside the polygon
+			for (T_ind k = firsts[v]; k < spokes.size() && spokes[k].from == v; ++k) {
+				const T_ind l = k + 1 == T_ind(spokes.size()) || spokes[k + 1].from != v ? firsts[v] : k + 1;
+				if (spokes[l].edge != null && before(v, spokes[k].to) && before(v, spokes[l].to))
+					walk(v, spokes[k].to, spokes[l].edge, found);
+			}
+		}
+	});
+
+	// Bring the parts into the order of their slots
+	std::vector<const T_ind*>& slot_parts = slabs.slot_parts;
+	slot_parts.assign(n_slots, nullptr);
+	for (T_ind c = T_ind(0); c < n_chunks; ++c) {
+		const std::vector<T_ind>& found = slabs.found[c];
+		for (const T_ind* it = found.data(); it != found.data() + found.size(); it += 5) {
+#ifdef DEBUG
+			if (it[4] == null || slot_parts[it[4]])
+				throw std::runtime_error("Found a part not created by exactly one vertex!");
+#endif
+			slot_parts[it[4]] = it;
+		}
+	}
+
+	std::vector<MonoPart<T_ind>>& parts = ws.parts;
+	for (auto&& it = slot_parts.cbegin(); it != slot_parts.cend(); ++it) {
+		if (!*it) continue; // a split vertex resolving a pending merge vertex creates no part
+		parts.emplace_back((*it)[0], (*it)[1], (*it)[2], null, null);
+		parts.back().tail = (*it)[3];
+	}
+
+	/* Finally: Keep the parts alongside the diagonals and update flags */
+	// MonoPart is not assignable, so the parts are copied element by element
+	this->parts.clear();
+	for (auto&& it = parts.cbegin(); it != parts.cend(); ++it)
+		this->parts.push_back(*it);
+
+	has_diagonals = n_diagonals > T_ind(0);
+	has_valid_diagonals = true;
+	has_valid_part_map = false; // parts kept for incremental updates are superseded
+	ws.lap(SWEEP);
+
+	return parts; // owned by the workspace
+}
+} // namespace fmt
+#endif
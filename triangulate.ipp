@@ -5,60 +5,183 @@
 
 #include "partition.hpp"
 #include "polygon.hpp"
+#include "workspace.hpp"
 
-#include <cmath>
-#include <iterator>
-#include <list>
+#ifndef FMT_NO_THREADS
+#	include "parallel.hpp"
+#endif
+
+#include <algorithm>
 #include <vector>
 
 namespace fmt {
 
-// Could also be implemented with OpenCL or OpenMP for lightning performance
 template<class T_vert, class T_ind>
-void Polygon<T_vert, T_ind>::triangulate(std::vector<MonoPart<T_ind>>* parts) {
-	indices.clear();
-	Polygon<T_vert, T_ind>& poly = *this;
-
-	for (auto&& it = parts->cbegin(); it != parts->cend(); ++it) {
-		const MonoPart<T_ind>& this_part = *it;
-
-		std::list<T_ind> L{this_part.head, poly[this_part.head + 1]->x < poly[this_part.head - 1]->x
-																					 ? this_part.head + 1
-																					 : this_part.head - 1};
-
-		// TODO: Properly cache part length
-		// L.reserve(std::abs(this_part.head - this_part.tail));
-		// FIXME: This is a very unprecise measure as it ignores all jumps etc and can tend to
-		// drastically overallocate
-
-		while (true) {
-			L.push_back(poly[L.front() + 1]->x < poly[L.front() - 1]->x ? L.front() + 1 : L.front() - 1);
-
-			if (L.back() == this_part.tail ||
-					(L.size() == 3 && (L.front() == *(std::next(L.begin())) + 1 == *(std::next(std::next(L.begin()))) + 2 ||
-														 L.front() == *(std::next(L.begin())) - 1 == *(std::next(std::next(L.begin()))) - 2))) {
-				// All on same chain
-				indices.push_back(L.front());
-				indices.push_back(*(std::next(L.begin())));
-				indices.push_back(*(std::next(std::next(L.begin()))));
-				// an homage to (cdr (cdr (cdr (list vertices))))
-
-				L.erase(L.begin());
-			} else {
-				for (auto&& it = L.cbegin(); it != (std::prev(std::prev(L.cend()))); ++it) {
-					indices.push_back(*it);
-					indices.push_back(*(std::next(it)));
-					indices.push_back(L.back());
+void Polygon<T_vert, T_ind>::triangulate(const std::vector<MonoPart<T_ind>>& parts,
+																				 Workspace<T_vert, T_ind>& ws, const unsigned threads) {
+	indices.resize(3 * triangle_count());
+	indices.resize(triangulate(parts, indices.data(), ws, threads));
 
-					it = std::prev(L.erase(it));
-				}
-			}
+	has_valid_indices = true;
+	has_valid_flips = false;
+}
 
-			if (L.back() == this_part.tail) break;
+template<class T_vert, class T_ind>
+T_ind Polygon<T_vert, T_ind>::triangulate(const std::vector<MonoPart<T_ind>>& parts, T_ind* out,
+																					Workspace<T_vert, T_ind>& ws, unsigned threads) const {
+	const T_ind* const out_end = out + 3 * triangle_count();
+	ws.start();
+
+#ifndef FMT_NO_THREADS
+	if (!threads) threads = _::default_threads();
+	if (threads > 1 && parts.size() > 1) {
+		// Every part is independent. The number of triangles of a part follows from the number of its
+		// vertices, so each part gets a precomputed range of the output to write to without locks.
+		std::vector<T_ind>& offsets = ws.part_offsets;
+		offsets.resize(parts.size() + 1);
+		offsets[0] = T_ind(0);
+
+		const T_ind grain = T_ind(8);
+		_::parallel_for(T_ind(parts.size()), grain, threads,
+										[&](const T_ind begin, const T_ind end, const unsigned) {
+											for (T_ind i = begin; i < end; ++i)
+												offsets[i + 1] = T_ind(3) * part_triangle_count(parts[i]);
+										});
+		// a part with k triangles has k + 2 vertices, which bounds its reflex chain
+		T_ind max_size = T_ind(0);
+		for (T_ind i = T_ind(0); i < parts.size(); ++i) {
+			max_size = std::max(max_size, offsets[i + 1]);
+			offsets[i + 1] += offsets[i];
 		}
+		max_size = max_size / T_ind(3) + T_ind(2);
+
+#	ifndef FMT_NOEXCEPT
+		if (out + offsets.back() > out_end)
+			throw std::length_error("Triangulation has more than n - 2 triangles. Is the polygon simple?");
+#	endif
+
+		if (ws.chains.size() < threads) ws.chains.resize(threads);
+		for (unsigned t = 0; t < threads; ++t)
+			if (ws.chains[t].size() < max_size) ws.chains[t].resize(max_size);
+
+		_::parallel_for(T_ind(parts.size()), grain, threads,
+										[&](const T_ind begin, const T_ind end, const unsigned t) {
+											for (T_ind i = begin; i < end; ++i) {
+												_::BufferOutput<T_ind> part_out{out + offsets[i], out + offsets[i + 1]};
+												triangulate_part(parts[i], part_out, ws.chains[t].data());
+											}
+										});
+
+		ws.lap(TRIANGULATE);
+		return offsets.back();
+	}
+#endif
+
+	// No part has more vertices than the polygon, so one stack of that size serves all of them
+	if (ws.chain.size() < n_verts) ws.chain.resize(n_verts);
+
+	_::BufferOutput<T_ind> buffer_out{out, out_end};
+	for (auto&& it = parts.cbegin(); it != parts.cend(); ++it)
+		triangulate_part(*it, buffer_out, ws.chain.data());
 
-		has_valid_indices = true;
+	ws.lap(TRIANGULATE);
+	return buffer_out.out - out;
+}
+
+template<class T_vert, class T_ind>
+template<class T_sink>
+void Polygon<T_vert, T_ind>::triangulate_stream(const std::vector<MonoPart<T_ind>>& parts,
+																								T_sink&& sink, Workspace<T_vert, T_ind>& ws,
+																								const T_ind chunk) const {
+#ifndef FMT_NOEXCEPT
+	if (chunk < T_ind(3)) throw std::invalid_argument("Chunks must hold at least one triangle.");
+#endif
+	ws.start();
+	if (ws.chain.size() < n_verts) ws.chain.resize(n_verts);
+	if (ws.stream_chunk.size() < chunk) ws.stream_chunk.resize(chunk);
+
+	T_ind* const begin = ws.stream_chunk.data();
+	_::SinkOutput<T_ind, T_sink> sink_out{sink, begin, begin + chunk - chunk % T_ind(3), begin,
+																				 triangle_count()};
+	for (auto&& it = parts.cbegin(); it != parts.cend(); ++it)
+		triangulate_part(*it, sink_out, ws.chain.data());
+	sink_out.flush();
+	ws.lap(TRIANGULATE);
+}
+
+template<class T_vert, class T_ind>
+T_ind Polygon<T_vert, T_ind>::part_triangle_count(const MonoPart<T_ind>& part) const {
+	// Every vertex between head and tail on either chain adds one triangle
+	T_ind count = T_ind(0);
+	for (T_ind i = part.first_upper; i != part.tail; i = nexts[i])
+		++count;
+	for (T_ind i = part.first_lower; i != part.tail; i = prevs[i])
+		++count;
+	return count;
+}
+
+// Could also be implemented with OpenCL for lightning performance
+template<class T_vert, class T_ind>
+template<class T_out>
+void Polygon<T_vert, T_ind>::triangulate_part(const MonoPart<T_ind>& this_part, T_out& out,
+																							T_ind* const L) const {
+	// Walk the upper chain along nexts and the lower chain along prevs, always taking the vertex
+	// swept first next, see _::is_before. L is the reflex chain of vertices which could not be cut
+	// off yet, kept as a flat stack with top pointing at its last element; all but its first element
+	// lie on the same chain, indicated by on_upper.
+	const T_ind tail = this_part.tail;
+	T_ind upper = this_part.first_upper, lower = this_part.first_lower;
+	T_ind* top = L;
+	*top = this_part.head;
+	bool on_upper = true;
+
+	// whether the diagonal from c to a lies inside the part, so that b can be cut off
+	auto cuts = [this](const T_ind a, const T_ind b, const T_ind c, const bool on_upper) {
+		return on_upper ? _::is_reflex(x(c), y(c), x(b), y(b), x(a), y(a))
+										: _::is_reflex(x(a), y(a), x(b), y(b), x(c), y(c));
+	};
+
+	while (upper != tail || lower != tail) {
+		const bool is_upper = lower == tail || (upper != tail && !before(lower, upper));
+		const T_ind this_vert = is_upper ? upper : lower;
+		if (is_upper)
+			upper = nexts[upper];
+		else
+			lower = prevs[lower];
+
+		if (top == L) {
+			*(++top) = this_vert;
+			on_upper = is_upper;
+		} else if (is_upper != on_upper) {
+			// Opposite chain: fan out to the whole reflex chain
+			for (const T_ind* it_l = L; it_l != top; ++it_l)
+				push_triangle(out, *it_l, *(it_l + 1), this_vert, on_upper);
+
+			L[0] = *top;
+			top = L + 1;
+			*top = this_vert;
+			on_upper = is_upper;
+		} else if (top == L + 1) {
+			// Convex runs keep two vertices on the stack and fan out from the first one
+			if (cuts(L[0], L[1], this_vert, on_upper)) {
+				push_triangle(out, L[0], L[1], this_vert, on_upper);
+				L[1] = this_vert;
+			} else {
+				*(++top) = this_vert;
+			}
+		} else {
+			// Same chain: cut off vertices as long as the diagonal lies inside the part
+			while (top != L && cuts(*(top - 1), *top, this_vert, on_upper)) {
+				push_triangle(out, *(top - 1), *top, this_vert, on_upper);
+				--top;
+			}
+			*(++top) = this_vert;
+		}
 	}
+
+	// The tail closes both chains
+	for (const T_ind* it_l = L; it_l != top; ++it_l)
+		push_triangle(out, *it_l, *(it_l + 1), tail, on_upper);
 }
 
 } // namespace fmt
@@ -0,0 +1,157 @@
+#ifndef FMT_WORKSPACE_H
+#define FMT_WORKSPACE_H
+
+/* Defines the workspace owning all scratch memory of the partition and triangulation algorithms */
+
+#include "eytzinger.hpp"
+#include "instrument.hpp"
+#include "partition.hpp"
+#include "rb_interval.hpp"
+#include "slabs.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace fmt {
+
+// Forward Declarations
+template<class T_vert, class T_ind>
+class Polygon;
+
+/*! Scratch memory for partitioning and triangulating polygons.
+
+	Owns all memory that fmt::Polygon::partition and fmt::Polygon::triangulate need while they run,
+	including the set of monotone parts handed from one to the other. Passing the same workspace to
+	successive calls of fmt::Polygon::get_indices reuses this memory: once the workspace has grown to
+	fit the largest polygon, triangulating a stream of polygons performs no further heap allocations.
+
+	The workspace is reset in Θ(1) at the beginning of each call; it does not need to be cleared by
+	the caller. A workspace must not be used by two calls at the same time.
+*/
+template<class T_vert, class T_ind>
+class Workspace {
+	friend class Polygon<T_vert, T_ind>;
+
+	typedef _::SplitVertex<T_vert, T_ind> Split;
+	typedef _::RB_Interval<typename _::Coord<T_vert>::Real, T_ind, T_ind> PartTree;
+
+	std::vector<_::EventVertex<T_ind>> evs;       //!< Set of all event vertices
+	std::vector<_::MergeVertex<T_ind>> ev_merges; //!< Set of merge vertex data
+	std::vector<T_ind> ev_starts;                 //!< Indices of start vertices in evs
+	std::vector<Split> ev_splits;                 //!< Set of split vertex data, including the dummy
+	std::vector<Split*> split_order;              //!< Split vertices sorted by x
+	std::vector<uint64_t> directions;             //!< Direction bit of each edge in index order
+
+	std::vector<Split*> split_scratch;                           //!< Scratch of the split sort
+	std::vector<T_ind> start_scratch;                            //!< Scratch of the start sort
+	std::vector<typename _::RadixKey<T_vert>::type> sort_keys;   //!< Radix keys of the sorts
+	std::vector<typename _::RadixKey<T_vert>::type> key_scratch; //!< Scratch of the radix keys
+
+	std::vector<T_vert> split_tree_keys; //!< Keys of the split search tree
+	std::vector<Split*> split_tree;      //!< Split vertices in the order of the search tree
+
+	std::vector<typename PartTree::Node> part_nodes; //!< Node pool of the RB interval tree
+	std::vector<_::RB_Link> free_nodes;              //!< Free list of the RB interval tree
+
+	std::vector<MonoPart<T_ind>> parts;    //!< Monotone parts as found by the partition
+	std::vector<MonoPart<T_ind>*> touched; //!< Parts changed since the sweep last updated the tree
+	std::vector<_::Wake<T_ind>> wakes;     //!< Heap of the parts to step, by their next event
+
+	std::vector<T_ind> chain; //!< Stack of the reflex chain of the triangulation, sized to fit
+
+	std::vector<std::vector<T_ind>> chains; //!< Reflex chains of the parallel triangulation per thread
+	std::vector<T_ind> part_offsets;        //!< Offsets of the parts in the parallel triangulation
+	std::vector<T_ind> stream_chunk;        //!< Chunk of indices handed to the sink when streaming
+
+	std::vector<T_ind> edge_offsets; //!< First edge of each vertex when finding adjacent triangles
+	std::vector<T_ind> edges;        //!< Edges of the triangles bucketed by their lower vertex
+	std::vector<T_ind> strip_twins;  //!< Opposite half-edge of each edge when joining strips
+	std::vector<T_ind> strip_order;  //!< Triangles in the order strips are started from
+	std::vector<uint8_t> strip_done; //!< Whether each triangle is part of a strip yet
+
+	Stats stats;                 //!< Statistics of all calls since the last reset
+	_::StageClock clock;         //!< Times the stages of the current call
+	Trace trace = nullptr;       //!< Called at the end of every stage
+	void* trace_user = nullptr;  //!< Passed to trace
+	uint64_t held_bytes = 0;     //!< Capacity of the workspace at the end of the last stage
+
+	_::Slabs<T_vert, T_ind> slabs;                         //!< State of the partition in slabs
+	std::vector<_::SlabSweep<T_vert, T_ind>> slab_sweeps; //!< Sweep of the slabs per thread
+
+	//! Begin timing the first stage of a call
+	void start() { clock.start(); }
+
+	//! End a stage: time it, record whether the workspace grew, and call the trace
+	void lap(const Stage stage) {
+		const uint64_t nanoseconds = clock.lap(stats, stage);
+#ifdef FMT_INSTRUMENT
+		const uint64_t held = capacity_bytes();
+		if (held > held_bytes) {
+			++stats.grown_stages;
+			stats.grown_bytes += held - held_bytes;
+			held_bytes = held;
+		}
+		if (trace) trace(stage, nanoseconds, stats, trace_user);
+#else
+		(void) nanoseconds;
+#endif
+	}
+
+	//! Bytes held by the vectors of the workspace. The state of the partition in slabs is not
+	//! included.
+	uint64_t capacity_bytes() const {
+		uint64_t bytes = bytes_of(evs) + bytes_of(ev_merges) + bytes_of(ev_starts) +
+										 bytes_of(ev_splits) + bytes_of(split_order) + bytes_of(directions) +
+										 bytes_of(split_scratch) + bytes_of(start_scratch) + bytes_of(sort_keys) +
+										 bytes_of(key_scratch) + bytes_of(split_tree_keys) + bytes_of(split_tree) +
+										 bytes_of(part_nodes) + bytes_of(free_nodes) + bytes_of(parts) +
+										 bytes_of(touched) + bytes_of(wakes) + bytes_of(chain) + bytes_of(chains) +
+										 bytes_of(part_offsets) + bytes_of(stream_chunk) +
+										 bytes_of(edge_offsets) + bytes_of(edges) + bytes_of(strip_twins) +
+										 bytes_of(strip_order) + bytes_of(strip_done);
+		for (auto&& it = chains.cbegin(); it != chains.cend(); ++it)
+			bytes += bytes_of(*it);
+		return bytes;
+	}
+
+	template<class T>
+	static uint64_t bytes_of(const std::vector<T>& vec) {
+		return uint64_t(vec.capacity()) * sizeof(T);
+	}
+
+public:
+	//! Reset the workspace in Θ(1). Keeps all allocated memory for reuse.
+	void clear() {
+		evs.clear();
+		ev_merges.clear();
+		ev_starts.clear();
+		ev_splits.clear();
+		split_order.clear();
+		part_nodes.clear();
+		free_nodes.clear();
+		parts.clear();
+		touched.clear();
+		wakes.clear();
+		part_offsets.clear();
+	}
+
+	//! Get the monotone parts found by the last call to fmt::Polygon::partition
+	const std::vector<MonoPart<T_ind>>& get_parts() const { return parts; }
+
+	//! Get the statistics of all calls using the workspace since the last reset. All zero unless
+	//! FMT_INSTRUMENT is defined.
+	const Stats& get_stats() const { return stats; }
+
+	//! Reset the statistics to zero
+	void reset_stats() { stats = Stats(); }
+
+	/*! Set a callback to invoke at the end of every stage, see fmt::Trace. Pass nullptr to remove
+		it. Never called unless FMT_INSTRUMENT is defined.
+	*/
+	void set_trace(const Trace callback, void* user = nullptr) {
+		trace = callback;
+		trace_user = user;
+	}
+};
+} // namespace fmt
+#endif